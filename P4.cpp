@@ -7,15 +7,83 @@
 
 using namespace LILC;
 
+static int
+usage()
+{
+   std::cout << "Usage: P4 [options] <infile> <outfile>" << std::endl;
+   std::cout << "  --fast-scanner  scan with the hand-written scanner instead"
+                " of the flex one" << std::endl;
+   std::cout << "  --descent  parse with the hand-written parser instead of"
+                " the bison one" << std::endl;
+   std::cout << "  --scope-stack  look names up in one table for every scope,"
+                " instead of scope by scope" << std::endl;
+   std::cout << "  --lazy     with --descent, parse function bodies after the"
+                " top level, on the --threads threads" << std::endl;
+   std::cout << "  --tokens   write the token stream instead of the"
+                " unparsed program" << std::endl;
+   std::cout << "  --binary   with --tokens(-to), write the binary token format"
+                " (P4 reads it back as input)" << std::endl;
+   std::cout << "  --tokens-to=FILE  also write the token stream to FILE"
+                " (the input is only scanned once)" << std::endl;
+   std::cout << "  --flat     build the flat, index-based AST instead of the"
+                " tree of nodes" << std::endl;
+   std::cout << "  --stream   analyze and unparse each declaration as it is"
+                " parsed, then free it (so name errors before a syntax error"
+                " are reported too)" << std::endl;
+   std::cout << "  --cache=DIR  keep parsed trees in DIR and reuse them while"
+                " the input is unchanged (implies --flat)" << std::endl;
+   std::cout << "  --threads=N  with --fast-scanner, scan in parallel on N"
+                " threads (0: one per core)" << std::endl;
+   return 1;
+}
+
 int 
 main( const int argc, const char **argv )
 {
-   if (argc != 3){
-	std::cout << "Usage: P4 <infile> <outfile>" << std::endl;
-	return 1;
+   LILC::LilC_Compiler compiler;
+   bool tokens = false;
+   bool binary = false;
+   const char * tokensTo = nullptr;
+   int arg = 1;
+   for( ; arg < argc && std::strncmp( argv[arg], "--", 2 ) == 0; arg++ ){
+	if( std::strcmp( argv[arg], "--fast-scanner" ) == 0 ){
+		compiler.setFlexScanner( false );
+	} else if( std::strcmp( argv[arg], "--descent" ) == 0 ){
+		compiler.setBisonParser( false );
+	} else if( std::strcmp( argv[arg], "--scope-stack" ) == 0 ){
+		compiler.setScopeListTable( false );
+	} else if( std::strcmp( argv[arg], "--lazy" ) == 0 ){
+		compiler.setLazyBodies( true );
+	} else if( std::strcmp( argv[arg], "--tokens" ) == 0 ){
+		tokens = true;
+	} else if( std::strcmp( argv[arg], "--binary" ) == 0 ){
+		binary = true;
+	} else if( std::strncmp( argv[arg], "--tokens-to=", 12 ) == 0 ){
+		tokensTo = argv[arg] + 12;
+	} else if( std::strcmp( argv[arg], "--flat" ) == 0 ){
+		compiler.setFlatAST( true );
+	} else if( std::strcmp( argv[arg], "--stream" ) == 0 ){
+		compiler.setStreaming( true );
+	} else if( std::strncmp( argv[arg], "--cache=", 8 ) == 0 ){
+		compiler.setCacheDirectory( argv[arg] + 8 );
+		compiler.setFlatAST( true );
+	} else if( std::strncmp( argv[arg], "--threads=", 10 ) == 0 ){
+		compiler.setThreads( std::atoi( argv[arg] + 10 ) );
+	} else {
+		return usage();
+	}
+   }
+   if (argc - arg != 2){
+	return usage();
    }
 
-   LILC::LilC_Compiler compiler;
-   compiler.nameAnalysis( argv[1], argv[2] );
+   if( tokens ){
+	compiler.scan( argv[arg], argv[arg + 1], binary );
+   } else {
+	if( tokensTo != nullptr ){
+		compiler.scan( argv[arg], tokensTo, binary );
+	}
+	compiler.nameAnalysis( argv[arg], argv[arg + 1] );
+   }
    return 0;
 }
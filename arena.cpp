@@ -0,0 +1,49 @@
+#include <cstdlib>
+
+#include "arena.hpp"
+
+namespace LILC{
+
+void Arena::grow(size_t atLeast){
+	size_t size = myChunkSize;
+	if (size < atLeast) {
+		size = atLeast;
+	}
+	Chunk * chunk = static_cast<Chunk *>(malloc(sizeof(Chunk) + size));
+	if (chunk == nullptr) {
+		throw std::bad_alloc();
+	}
+	chunk->next = myChunks;
+	chunk->size = size;
+	myChunks = chunk;
+	myPtr = reinterpret_cast<char *>(chunk + 1);
+	myEnd = myPtr + size;
+	myReserved += size;
+}
+
+void Arena::release(){
+	while (myChunks != nullptr) {
+		Chunk * next = myChunks->next;
+		free(myChunks);
+		myChunks = next;
+	}
+	myPtr = nullptr;
+	myEnd = nullptr;
+	myReserved = 0;
+}
+
+void Arena::reset(){
+	if (myChunks == nullptr) {
+		return;
+	}
+	Chunk * keep = myChunks;
+	myChunks = keep->next;
+	release();
+	keep->next = nullptr;
+	myChunks = keep;
+	myPtr = reinterpret_cast<char *>(keep + 1);
+	myEnd = myPtr + keep->size;
+	myReserved = keep->size;
+}
+
+}
@@ -0,0 +1,103 @@
+#ifndef LILC_ARENA_HPP
+#define LILC_ARENA_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace LILC{
+
+//A bump allocator. Allocation is a pointer increment into the current
+// chunk; everything is given back at once by release(). Destructors of
+// objects built here are never run, so only put things here that don't
+// need them (or whose owner calls them itself).
+class Arena{
+public:
+	Arena(size_t chunkSize = 64 * 1024) : myChunkSize(chunkSize) { }
+	~Arena() { release(); }
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void * allocate(size_t size, size_t align = alignof(std::max_align_t)){
+		size_t pad = -reinterpret_cast<size_t>(myPtr) & (align - 1);
+		if (myPtr == nullptr || (size_t)(myEnd - myPtr) < size + pad) {
+			grow(size + align);
+			pad = -reinterpret_cast<size_t>(myPtr) & (align - 1);
+		}
+		void * result = myPtr + pad;
+		myPtr += pad + size;
+		return result;
+	}
+
+	template<typename T, typename... Args>
+	T * make(Args&&... args){
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	T * makeArray(size_t count){
+		return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	std::string_view copy(std::string_view text){
+		char * dest = makeArray<char>(text.size());
+		memcpy(dest, text.data(), text.size());
+		return std::string_view(dest, text.size());
+	}
+
+	// Frees every chunk.
+	void release();
+	// Like release, but keeps the newest chunk around for the next
+	// round of allocations.
+	void reset();
+	size_t bytesReserved() const { return myReserved; }
+
+private:
+	struct Chunk{
+		Chunk * next;
+		size_t size;
+	};
+	void grow(size_t atLeast);
+
+	Chunk * myChunks = nullptr;
+	char * myPtr = nullptr;
+	char * myEnd = nullptr;
+	size_t myChunkSize;
+	size_t myReserved = 0;
+};
+
+//Lets a standard container allocate from an Arena. Nothing is given
+// back until the arena is, so the container's destructor can be
+// skipped along with everything else's.
+template<typename T>
+class ArenaAllocator{
+public:
+	typedef T value_type;
+	// a container moved or swapped into takes the arena along
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+
+	// Allocates nothing until it is given an arena, by assignment
+	ArenaAllocator() : myArena(nullptr) { }
+	ArenaAllocator(Arena& arena) : myArena(&arena) { }
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : myArena(other.arena()) { }
+
+	T * allocate(size_t count) { return myArena->makeArray<T>(count); }
+	void deallocate(T *, size_t) { }
+	Arena * arena() const { return myArena; }
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U>& other) const { return myArena == other.arena(); }
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const { return myArena != other.arena(); }
+
+private:
+	Arena * myArena;
+};
+
+}
+#endif
@@ -3,23 +3,30 @@
 // AST nodes
 namespace LILC{
 
-std::string FormalsListNode::getTypes() {
-    std::string result = "";
-    for (std::list<FormalDeclNode *>::iterator
-      it=myFormals->begin();
-      it != myFormals->end(); ++it){
+LineTable * ASTNode::ourLines = nullptr;
+thread_local size_t ASTNode::ourCreated = 0;
+
+void ASTNode::reportError(std::string error, std::string id) {
+  size_t line, column;
+  if (ourLines != nullptr && ourLines->position(myOffset, &line, &column)) {
+    std::cout << line << ":" << column;
+  }
+  std::cout << " ***ERROR*** " << error << ": " << id << "\n";
+}
+
+std::vector<const Type *> FormalsListNode::getTypes() {
+    std::vector<const Type *> result;
+    for (FormalsSpan::iterator
+      it=myFormals.begin();
+      it != myFormals.end(); ++it){
         FormalDeclNode * elt = *it;
-        result += elt->getType();
-      if(next(it) != myFormals->end())
-      {
-        result += ",";
-      }
+        result.push_back(elt->getType());
     }
     return result;
 }
 
 std::string IdNode::getId() {
-  return myStrVal;
+  return std::string(atomText(myAtom));
 }
 
 std::string DotAccessNode::getType() {
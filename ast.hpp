@@ -2,8 +2,10 @@
 #define LILC_AST_HPP
 
 #include <ostream>
-#include <list>
+#include <vector>
 #include "tokens.hpp"
+#include "line_table.hpp"
+#include "arena.hpp"
 #include "symbol_table.hpp"
 
 namespace LILC{
@@ -21,16 +23,59 @@ class TypeNode;
 class ExpNode;
 class IdNode;
 
+//Nodes, and the lists of children in them, are built in the
+// compiler's AST arena and freed with it; none has a destructor to run.
+// The parser grows each list of children as an ASTList (which the bison
+// parser keeps in the arena too, see ASTBuilder::handle); the node it
+// ends up in keeps an ASTSpan over the same (contiguous) storage, which
+// outlives the list itself.
+template<typename T>
+using ASTList = std::vector<T, ArenaAllocator<T>>;
+typedef ASTList<DeclNode *> DeclList;
+typedef ASTList<FormalDeclNode *> FormalsList;
+typedef ASTList<StmtNode *> StmtList;
+typedef ASTList<ExpNode *> ExpList;
+
+template<typename T>
+class ASTSpan{
+public:
+	typedef T const * iterator;
+	ASTSpan(const ASTList<T>& list) : myData(list.data()), mySize(list.size()) { }
+	iterator begin() const { return myData; }
+	iterator end() const { return myData + mySize; }
+	size_t size() const { return mySize; }
+private:
+	T const * myData;
+	size_t mySize;
+};
+typedef ASTSpan<DeclNode *> DeclSpan;
+typedef ASTSpan<FormalDeclNode *> FormalsSpan;
+typedef ASTSpan<StmtNode *> StmtSpan;
+typedef ASTSpan<ExpNode *> ExpSpan;
+
 class ASTNode{
 public:
+	ASTNode() { ourCreated++; }
 	virtual void unparse(std::ostream& out, int indent) = 0;
 	virtual bool nameAnalysis(SymbolTable * symTab) = 0;
 	void doIndent(std::ostream& out, int indent){
 		for (int k = 0 ; k < indent; k++){ out << " "; }
 	}
-	void reportError(std::string error, std::string id) {
-		std::cout << " ***ERROR*** " << error << ": " << id[0] << "\n";
-	}
+	// reported at this node's position in the source
+	void reportError(std::string error, std::string id);
+
+	// byte offset of the first token of the node
+	uint32_t offset() { return myOffset; }
+	void setOffset(uint32_t offset) { myOffset = offset; }
+	// where reportError looks offsets up; may be null
+	static void setLineTable(LineTable * lines) { ourLines = lines; }
+	// nodes built so far on this thread, for the benchmark
+	static size_t created() { return ourCreated; }
+protected:
+	uint32_t myOffset = 0;
+private:
+	static LineTable * ourLines;
+	static thread_local size_t ourCreated;
 };
 
 class ProgramNode : public ASTNode{
@@ -46,13 +91,12 @@ private:
 
 class DeclListNode : public ASTNode{
 public:
-	DeclListNode(std::list<DeclNode *> * decls) : ASTNode(){
-        	myDecls = decls;
+	DeclListNode(const DeclList& decls) : ASTNode(), myDecls(decls){
 	}
 	bool nameAnalysis(SymbolTable * symTab);
 	void unparse(std::ostream& out, int indent);
 private:
-	std::list<DeclNode *> * myDecls;
+	DeclSpan myDecls;
 };
 
 class DeclNode : public ASTNode{
@@ -70,7 +114,7 @@ public:
 	}
 	bool nameAnalysis(SymbolTable * symTab);
 	void unparse(std::ostream& out, int indent);
-	static const int NOT_STRUCT = -1; //Use this value for mySize
+	static constexpr int NOT_STRUCT = -1; //Use this value for mySize
 					  // if this is not a struct type
 private:
 	TypeNode * myType;
@@ -94,36 +138,34 @@ public:
 
 class FormalsListNode : public ASTNode{
 public:
-	FormalsListNode(std::list<FormalDeclNode *> * formalsIn) : ASTNode(){
-		myFormals = formalsIn;
+	FormalsListNode(const FormalsList& formalsIn) : ASTNode(), myFormals(formalsIn){
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string getTypes();
+	// the type of each formal, in order
+	std::vector<const Type *> getTypes();
 private:
-	std::list<FormalDeclNode *> * myFormals;
+	FormalsSpan myFormals;
 };
 
 class ExpListNode : public ASTNode{
 public:
-	ExpListNode(std::list<ExpNode *> * exps) : ASTNode(){
-		myExps = *exps;
+	ExpListNode(const ExpList& exps) : ASTNode(), myExps(exps){
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
 private:
-	std::list<ExpNode *> myExps;
+	ExpSpan myExps;
 };
 
 class StmtListNode : public ASTNode{
 public:
-	StmtListNode(std::list<StmtNode *> * stmtsIn) : ASTNode(){
-		myStmts = stmtsIn;
+	StmtListNode(const StmtList& stmtsIn) : ASTNode(), myStmts(stmtsIn){
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
 private:
-	std::list<StmtNode *> * myStmts;
+	StmtSpan myStmts;
 };
 
 class FnBodyNode : public ASTNode{
@@ -132,6 +174,13 @@ public:
 		myDeclList = decls;
 		myStmtList = stmts;
 	}
+	// A body the parser skipped is built with null lists, and filled
+	// in here when it is parsed (see DescentParser::parseBody)
+	void setBody(DeclListNode * decls, StmtListNode * stmts){
+		myDeclList = decls;
+		myStmtList = stmts;
+	}
+	bool parsed() { return myDeclList != nullptr; }
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
 private:
@@ -159,9 +208,13 @@ private:
 
 class TypeNode : public ASTNode{
 public:
+	TypeNode(const Type * type) : ASTNode(), myType(type){ }
 	virtual void unparse(std::ostream& out, int indent) = 0;
 	virtual bool nameAnalysis(SymbolTable * symTab) = 0;
-	virtual std::string getType() = 0;
+	// interned, so types compare with ==
+	const Type * getType() {return myType;}
+protected:
+	const Type * myType;
 };
 
 class FormalDeclNode : public DeclNode{
@@ -172,7 +225,7 @@ public:
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string getType() {return myType->getType();}
+	const Type * getType() {return myType->getType();}
 private:
 	TypeNode * myType;
 	IdNode * myId;
@@ -186,7 +239,7 @@ public:
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	static const int NOT_STRUCT = -1; //Use this value for mySize
+	static constexpr int NOT_STRUCT = -1; //Use this value for mySize
 					  // if this is not a struct type
 private:
 	IdNode * myId;
@@ -195,60 +248,61 @@ private:
 
 class IntNode : public TypeNode{
 public:
-	IntNode(): TypeNode(){ }
+	IntNode(): TypeNode(TypeTable::global().intType()){ }
+	// the one IntNode, which ASTBuilder hands out for every int
+	static IntNode * instance() { static IntNode node; return &node; }
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string getType() {return "int";}
 };
 
 class BoolNode : public TypeNode{
 public:
-	BoolNode(): TypeNode(){ }
+	BoolNode(): TypeNode(TypeTable::global().boolType()){ }
+	// the one BoolNode, which ASTBuilder hands out for every bool
+	static BoolNode * instance() { static BoolNode node; return &node; }
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string getType() {return "bool";}
 };
 
 class VoidNode : public TypeNode{
 public:
-	VoidNode(): TypeNode(){ }
+	VoidNode(): TypeNode(TypeTable::global().voidType()){ }
+	// the one VoidNode, which ASTBuilder hands out for every void
+	static VoidNode * instance() { static VoidNode node; return &node; }
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string getType() {return "void";}
 };
 
 class IdNode : public ExpNode{
 public:
-	IdNode(IDToken * token) : ExpNode(){
-		myStrVal = token->value();
+	IdNode(Atom atom) : ExpNode(){
+		myAtom = atom;
 		myEntry = nullptr;
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
 	std::string getId();
-	std::string getType() {return myStrVal;}
+	Atom getAtom() {return myAtom;}
+	std::string getType() {return getId();}
 	SymbolTableEntry* getEntry() {return myEntry;}
+	void setEntry(SymbolTableEntry* entry) {myEntry = entry;}
 private:
-	std::string myStrVal;
+	Atom myAtom;
 	SymbolTableEntry* myEntry;
 };
 
 class StructNode : public TypeNode{
 public:
-	StructNode(IdNode * id): TypeNode(){
-		myId = id;
-	}
+	// only id's name is kept, as the type
+	StructNode(IdNode * id): TypeNode(TypeTable::global().structType(id->getAtom())){ }
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-	std::string getType() {return myId->getId();}
-private:
-	IdNode * myId;
 };
 
 class IntLitNode : public ExpNode{
 public:
-	IntLitNode(IntLitToken * token): ExpNode(){
-		myInt = token->value();
+	IntLitNode(int value): ExpNode(){
+		myInt = value;
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
@@ -260,15 +314,15 @@ private:
 
 class StrLitNode : public ExpNode{
 public:
-	StrLitNode(StringLitToken * token): ExpNode(){
-		myString = token->value();
+	StrLitNode(std::string_view text): ExpNode(){
+		myString = text;
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
 	std::string getType() {return "string";}
 	SymbolTableEntry* getEntry() {return nullptr;}
 private:
-	 std::string myString;
+	 std::string_view myString; //in the AST arena
 };
 
 class TrueNode : public ExpNode{
@@ -367,168 +421,100 @@ private:
 	ExpNode * myExp;
 };
 
-class BinaryExpNode : public ExpNode{
-public:
-	virtual void unparse(std::ostream& out, int indent) = 0;
-	virtual bool nameAnalysis(SymbolTable * symTab) = 0;
-	std::string getType() {return "binary";}
-	SymbolTableEntry* getEntry() {return nullptr;}
+enum class OpKind {
+	Plus, Minus, Times, Divide, And, Or,
+	Equals, NotEquals, Less, Greater, LessEq, GreaterEq
 };
 
-class PlusNode : public BinaryExpNode{
+//The subclasses differ only in their operator, so unparse and
+// nameAnalysis live here and unparse switches on myOp.
+class BinaryExpNode : public ExpNode{
 public:
-	PlusNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
+	BinaryExpNode(OpKind op, ExpNode * exp1, ExpNode * exp2) : ExpNode(){
+		myOp = op;
 		myExp1 = exp1;
 		myExp2 = exp2;
 	}
 	void unparse(std::ostream& out, int indent);
 	bool nameAnalysis(SymbolTable * symTab);
-private:
+	std::string getType() {return "binary";}
+	SymbolTableEntry* getEntry() {return nullptr;}
+protected:
+	OpKind myOp;
 	ExpNode * myExp1;
 	ExpNode * myExp2;
 };
 
+class PlusNode : public BinaryExpNode{
+public:
+	PlusNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Plus, exp1, exp2){
+	}
+};
+
 class MinusNode : public BinaryExpNode{
 public:
-	MinusNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	MinusNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Minus, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class TimesNode : public BinaryExpNode{
 public:
-	TimesNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	TimesNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Times, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class DivideNode : public BinaryExpNode{
 public:
-	DivideNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	DivideNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Divide, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class AndNode : public BinaryExpNode{
 public:
-	AndNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	AndNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::And, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class OrNode : public BinaryExpNode{
 public:
-	OrNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	OrNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Or, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class EqualsNode : public BinaryExpNode{
 public:
-	EqualsNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	EqualsNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Equals, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class NotEqualsNode : public BinaryExpNode{
 public:
-	NotEqualsNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	NotEqualsNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::NotEquals, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class LessNode : public BinaryExpNode{
 public:
-	LessNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	LessNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Less, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class GreaterNode : public BinaryExpNode{
 public:
-	GreaterNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	GreaterNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::Greater, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class LessEqNode : public BinaryExpNode{
 public:
-	LessEqNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	LessEqNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::LessEq, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class GreaterEqNode : public BinaryExpNode{
 public:
-	GreaterEqNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(){
-		myExp1 = exp1;
-		myExp2 = exp2;
+	GreaterEqNode(ExpNode * exp1, ExpNode * exp2): BinaryExpNode(OpKind::GreaterEq, exp1, exp2){
 	}
-	void unparse(std::ostream& out, int indent);
-	bool nameAnalysis(SymbolTable * symTab);
-private:
-	ExpNode * myExp1;
-	ExpNode * myExp2;
 };
 
 class AssignStmtNode : public StmtNode{
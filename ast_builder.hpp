@@ -0,0 +1,171 @@
+#ifndef LILC_AST_BUILDER_HPP
+#define LILC_AST_BUILDER_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "ast.hpp"
+#include "flat_ast.hpp"
+
+namespace LILC{
+
+//The FlatAST tag of each ASTNode class
+template<typename T> struct FlatTag;
+#define LILC_FLAT_TAG(Class, Name) \
+	template<> struct FlatTag<Class>{ static constexpr FlatAST::Tag value = FlatAST::Tag::Name; };
+LILC_FLAT_TAG(ProgramNode, Program)
+LILC_FLAT_TAG(DeclListNode, DeclList)
+LILC_FLAT_TAG(VarDeclNode, VarDecl)
+LILC_FLAT_TAG(FnDeclNode, FnDecl)
+LILC_FLAT_TAG(FormalsListNode, FormalsList)
+LILC_FLAT_TAG(FormalDeclNode, FormalDecl)
+LILC_FLAT_TAG(StructDeclNode, StructDecl)
+LILC_FLAT_TAG(FnBodyNode, FnBody)
+LILC_FLAT_TAG(StmtListNode, StmtList)
+LILC_FLAT_TAG(ExpListNode, ExpList)
+LILC_FLAT_TAG(IntNode, Int)
+LILC_FLAT_TAG(BoolNode, Bool)
+LILC_FLAT_TAG(VoidNode, Void)
+LILC_FLAT_TAG(StructNode, Struct)
+LILC_FLAT_TAG(IdNode, Id)
+LILC_FLAT_TAG(IntLitNode, IntLit)
+LILC_FLAT_TAG(StrLitNode, StrLit)
+LILC_FLAT_TAG(TrueNode, True)
+LILC_FLAT_TAG(FalseNode, False)
+LILC_FLAT_TAG(DotAccessNode, DotAccess)
+LILC_FLAT_TAG(AssignNode, Assign)
+LILC_FLAT_TAG(CallExpNode, CallExp)
+LILC_FLAT_TAG(UnaryMinusNode, UnaryMinus)
+LILC_FLAT_TAG(NotNode, Not)
+LILC_FLAT_TAG(PlusNode, Plus)
+LILC_FLAT_TAG(MinusNode, Minus)
+LILC_FLAT_TAG(TimesNode, Times)
+LILC_FLAT_TAG(DivideNode, Divide)
+LILC_FLAT_TAG(AndNode, And)
+LILC_FLAT_TAG(OrNode, Or)
+LILC_FLAT_TAG(EqualsNode, Equals)
+LILC_FLAT_TAG(NotEqualsNode, NotEquals)
+LILC_FLAT_TAG(LessNode, Less)
+LILC_FLAT_TAG(GreaterNode, Greater)
+LILC_FLAT_TAG(LessEqNode, LessEq)
+LILC_FLAT_TAG(GreaterEqNode, GreaterEq)
+LILC_FLAT_TAG(AssignStmtNode, AssignStmt)
+LILC_FLAT_TAG(PostIncStmtNode, PostIncStmt)
+LILC_FLAT_TAG(PostDecStmtNode, PostDecStmt)
+LILC_FLAT_TAG(ReadStmtNode, ReadStmt)
+LILC_FLAT_TAG(WriteStmtNode, WriteStmt)
+LILC_FLAT_TAG(IfStmtNode, IfStmt)
+LILC_FLAT_TAG(IfElseStmtNode, IfElseStmt)
+LILC_FLAT_TAG(WhileStmtNode, WhileStmt)
+LILC_FLAT_TAG(CallStmtNode, CallStmt)
+LILC_FLAT_TAG(ReturnStmtNode, ReturnStmt)
+#undef LILC_FLAT_TAG
+
+template<typename L> struct FlatListTag;
+template<> struct FlatListTag<DeclList>{ static constexpr FlatAST::Tag value = FlatAST::Tag::DeclList; };
+template<> struct FlatListTag<FormalsList>{ static constexpr FlatAST::Tag value = FlatAST::Tag::FormalsList; };
+template<> struct FlatListTag<StmtList>{ static constexpr FlatAST::Tag value = FlatAST::Tag::StmtList; };
+template<> struct FlatListTag<ExpList>{ static constexpr FlatAST::Tag value = FlatAST::Tag::ExpList; };
+
+//What the grammar actions build nodes through. Normally that is the
+// tree of ASTNodes, in an arena; given a FlatAST, it is that instead,
+// and every node the actions get back is null and every list empty.
+//
+// The flat tree is built from the order of the calls alone, so they
+// have to come in the order the parser reduces: no action may build a
+// node with children from more than one level of its rule.
+class ASTBuilder{
+public:
+	ASTBuilder(Arena& nodes, FlatAST * flat = nullptr)
+	: myNodes(nodes), myFlat(flat) { }
+
+	void setFlat(FlatAST * flat) { myFlat = flat; }
+	FlatAST * flat() const { return myFlat; }
+
+	// A T at offset, from the same arguments as its constructor
+	template<typename T, typename... Args>
+	T * make(uint32_t offset, Args&&... args){
+		if (myFlat == nullptr) {
+			if constexpr (std::is_same_v<T, IntNode> || std::is_same_v<T, BoolNode>
+			  || std::is_same_v<T, VoidNode>) {
+				//shared by every use, so it has no one offset to keep
+				return T::instance();
+			}
+			T * node = myNodes.make<T>(std::forward<Args>(args)...);
+			node->setOffset(offset);
+			return node;
+		}
+		constexpr FlatAST::Tag tag = FlatTag<T>::value;
+		constexpr unsigned children = (0 + ... + std::is_pointer<std::decay_t<Args>>::value);
+		if constexpr (tag == FlatAST::Tag::DeclList || tag == FlatAST::Tag::FormalsList
+		  || tag == FlatAST::Tag::StmtList || tag == FlatAST::Tag::ExpList) {
+			//the list became a node when it was opened
+		} else if constexpr (children == 0) {
+			myFlat->leaf(tag, offset, payload(args...));
+		} else {
+			myFlat->node(tag, offset, children);
+		}
+		return nullptr;
+	}
+
+	// A new list at offset, empty or holding first. Its items go in
+	// the arena; the list itself is moved along the parser's stack, or
+	// for the bison parser, whose stack is a union of pointers, made
+	// in the arena by handle() and appended to in place.
+	template<typename L>
+	L list(uint32_t offset){
+		if (myFlat != nullptr) {
+			myFlat->openList(FlatListTag<L>::value, offset);
+		}
+		return L(myNodes);
+	}
+	template<typename L, typename T>
+	L list(uint32_t offset, T first){
+		L result(myNodes);
+		if (myFlat == nullptr) {
+			result.push_back(first);
+		} else {
+			myFlat->openList(FlatListTag<L>::value, offset, 1);
+		}
+		return result;
+	}
+	template<typename L, typename T>
+	L append(L&& list, T item){
+		if (myFlat == nullptr) {
+			list.push_back(item);
+		} else {
+			myFlat->append();
+		}
+		return std::move(list);
+	}
+	template<typename L>
+	L * handle(L&& list){
+		return myNodes.make<L>(std::move(list));
+	}
+	template<typename L, typename T>
+	L * append(L * list, T item){
+		if (myFlat == nullptr) {
+			list->push_back(item);
+		} else {
+			myFlat->append();
+		}
+		return list;
+	}
+
+	std::string_view copy(std::string_view text) { return myNodes.copy(text); }
+	Arena& nodes() { return myNodes; }
+
+private:
+	uint32_t payload() { return 0; }
+	uint32_t payload(std::nullptr_t) { return FlatAST::NoNode; }
+	uint32_t payload(uint32_t value) { return value; }
+	uint32_t payload(std::string_view text) { return myFlat->addString(text); }
+
+	Arena& myNodes;
+	FlatAST * myFlat;
+};
+
+}
+#endif
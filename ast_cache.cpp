@@ -0,0 +1,158 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ast_cache.hpp"
+#include "buffered_writer.hpp"
+
+namespace LILC{
+
+static const char MAGIC[8] = { 'L', 'I', 'L', 'C', 'A', 'S', 'T', '1' };
+
+//Where the hashes sit after the magic, and where the tree starts
+struct CacheHeader{
+	uint64_t sourceSize;
+	uint64_t sourceHash;
+	uint64_t bodyHash;
+};
+static const size_t BODY = sizeof(MAGIC) + sizeof(CacheHeader);
+
+static const uint64_t PRIME1 = 11400714785074694791ULL;
+static const uint64_t PRIME2 = 14029467366897019727ULL;
+static const uint64_t PRIME3 = 1609587929392839161ULL;
+static const uint64_t PRIME4 = 9650029242287828579ULL;
+static const uint64_t PRIME5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl(uint64_t x, int r){ return (x << r) | (x >> (64 - r)); }
+static inline uint64_t load64(const char * p){ uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint32_t load32(const char * p){ uint32_t v; memcpy(&v, p, 4); return v; }
+static inline uint64_t mix(uint64_t acc, uint64_t input){
+	return rotl(acc + input * PRIME2, 31) * PRIME1;
+}
+static inline uint64_t merge(uint64_t acc, uint64_t lane){
+	return (acc ^ mix(0, lane)) * PRIME1 + PRIME4;
+}
+
+uint64_t contentHash(const char * data, size_t size){
+	const char * p = data;
+	const char * end = data + size;
+	uint64_t h;
+	if (size >= 32) {
+		//four independent lanes, so the multiplies overlap
+		uint64_t v1 = PRIME1 + PRIME2, v2 = PRIME2, v3 = 0, v4 = -PRIME1;
+		for (; end - p >= 32; p += 32) {
+			v1 = mix(v1, load64(p));
+			v2 = mix(v2, load64(p + 8));
+			v3 = mix(v3, load64(p + 16));
+			v4 = mix(v4, load64(p + 24));
+		}
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+	} else {
+		h = PRIME5;
+	}
+	h += size;
+	for (; end - p >= 8; p += 8) {
+		h = rotl(h ^ mix(0, load64(p)), 27) * PRIME1 + PRIME4;
+	}
+	if (end - p >= 4) {
+		h = rotl(h ^ load32(p) * PRIME1, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		h = rotl(h ^ (unsigned char)*p * PRIME5, 11) * PRIME1;
+	}
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	return h ^ (h >> 32);
+}
+
+std::string ASTCache::path(uint64_t hash) const {
+	char name[24];
+	std::snprintf(name, sizeof(name), "%016llx.ast", (unsigned long long)hash);
+	return myDir + "/" + name;
+}
+
+bool ASTCache::load(std::string_view text, uint64_t hash, FlatAST * tree, SourceFile * file){
+	if (!file->map(path(hash).c_str())) {
+		return false;
+	}
+	CacheHeader header;
+	if (file->size() < BODY || memcmp(file->data(), MAGIC, sizeof(MAGIC)) != 0) {
+		file->unmap();
+		return false;
+	}
+	memcpy(&header, file->data() + sizeof(MAGIC), sizeof(header));
+	const char * body = file->data() + BODY;
+	size_t bodySize = file->size() - BODY;
+	if (header.sourceSize != text.size() || header.sourceHash != hash
+	  || header.bodyHash != contentHash(body, bodySize)
+	  || !tree->read(body, bodySize)) {
+		file->unmap();
+		return false;
+	}
+	return true;
+}
+
+//Makes dir and any of its parents that are missing, like mkdir -p
+static bool makeDirectories(const std::string& dir){
+	for (size_t slash = dir.find('/', 1); ; slash = dir.find('/', slash + 1)) {
+		std::string prefix = dir.substr(0, slash);
+		if (mkdir(prefix.c_str(), 0777) != 0 && errno != EEXIST) {
+			return false;
+		}
+		if (slash == std::string::npos) {
+			break;
+		}
+	}
+	struct stat info;
+	return stat(dir.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool ASTCache::store(std::string_view text, uint64_t hash, const FlatAST& tree){
+	if (!makeDirectories(myDir)) {
+		return false;
+	}
+	std::string target = path(hash);
+	//mkstemp picks a name no other run is writing
+	std::string temp = myDir + "/.ast.XXXXXX";
+	BufferedWriter out;
+	if (!out.open(mkstemp(&temp[0]))) {
+		return false;
+	}
+	CacheHeader header = { text.size(), hash, 0 };
+	out.write(MAGIC, sizeof(MAGIC));
+	out.write(&header, sizeof(header));
+	tree.write(out);
+	if (!out.close()) {
+		unlink(temp.c_str());
+		return false;
+	}
+
+	//The body's hash goes in last, from the file as written
+	bool stored = false;
+	{
+		SourceFile written;
+		if (written.map(temp.c_str()) && written.size() >= BODY) {
+			header.bodyHash = contentHash(written.data() + BODY, written.size() - BODY);
+			int fd = open(temp.c_str(), O_WRONLY);
+			stored = fd >= 0 && pwrite(fd, &header, sizeof(header), sizeof(MAGIC))
+			  == (ssize_t)sizeof(header);
+			if (fd >= 0) {
+				stored = close(fd) == 0 && stored;
+			}
+		}
+	}
+	if (!stored || rename(temp.c_str(), target.c_str()) != 0) {
+		unlink(temp.c_str());
+		return false;
+	}
+	return true;
+}
+
+}
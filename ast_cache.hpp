@@ -0,0 +1,49 @@
+#ifndef LILC_AST_CACHE_HPP
+#define LILC_AST_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "flat_ast.hpp"
+#include "source_file.hpp"
+
+namespace LILC{
+
+// xxHash64 (seed 0) of size bytes at data
+uint64_t contentHash(const char * data, size_t size);
+
+//A directory of parsed trees, each in a file named for the hash of the
+// source text it was parsed from, so that an unchanged input is loaded
+// by mapping its file rather than scanned and parsed again. A file is
+//
+//   "LILCAST1"
+//   source size, source hash, body hash (64-bit, host byte order)
+//   the tree, as FlatAST::write puts it
+//
+// The source size and hash are checked against the input, and the body
+// hash against the rest of the file, before the tree is used. Files are
+// written under a temporary name and renamed into place, so concurrent
+// runs never see half a file.
+class ASTCache{
+public:
+	// "" turns the cache off; dir, and any parents it lacks, are made
+	// when the first tree is stored
+	void setDirectory(const std::string& dir) { myDir = dir; }
+	bool enabled() const { return !myDir.empty(); }
+
+	// Loads the tree stored for text, if any, mapping its file into
+	// file, which must outlive the tree.
+	bool load(std::string_view text, uint64_t hash, FlatAST * tree, SourceFile * file);
+	// Stores tree as text's; returns false if it couldn't be written
+	bool store(std::string_view text, uint64_t hash, const FlatAST& tree);
+
+private:
+	std::string path(uint64_t hash) const;
+
+	std::string myDir;
+};
+
+}
+#endif
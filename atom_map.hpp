@@ -0,0 +1,181 @@
+#ifndef LILC_ATOM_MAP_HPP
+#define LILC_ATOM_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "atom_table.hpp"
+
+namespace LILC{
+
+//A map from atoms to pointers, for the small tables of a scope. Up to
+// INLINE keys are kept in the map itself and compared with the key
+// all at once, which is all most scopes need. Past that it is an open-addressing
+// table in the style of SwissTable: slots come in groups of 16, each
+// with a byte of control per slot, either Empty or 7 bits of the key's
+// hash. A probe compares a whole group's control bytes at once (with
+// SSE2 when there is SSE2) and only looks at the slots whose bytes
+// match. Groups start 16 bytes apart in a vector, so one group's
+// control bytes never straddle a cache line.
+//
+// Nothing is ever erased, so there are no tombstones. V is a pointer
+// type, and find returns null for a key that isn't there.
+template<typename V>
+class AtomMap{
+public:
+	size_t size() const { return mySize; }
+
+	V find(Atom key) const {
+		if (myCapacity == 0) {
+			uint32_t match = inlineMatches(key);
+			return match != 0 ? myInlineValues[lowestBit(match)] : nullptr;
+		}
+		uint64_t h = hash(key);
+		for (size_t group = firstGroup(h); ; group = nextGroup(group)) {
+			const int8_t * control = myControl.data() + group * GROUP;
+			for (uint32_t match = matches(control, tagOf(h)); match != 0; match &= match - 1) {
+				const Slot& slot = mySlots[group * GROUP + lowestBit(match)];
+				if (slot.key == key) {
+					return slot.value;
+				}
+			}
+			if (empties(control) != 0) {
+				return nullptr;
+			}
+		}
+	}
+
+	// Empties the map, keeping its memory for the next keys
+	void clear(){
+		if (myCapacity != 0 && mySize != 0) {
+			myControl.assign(myCapacity, Empty);
+		}
+		mySize = 0;
+	}
+
+	// Returns false, keeping the old value, if key is there already
+	bool insert(Atom key, V value){
+		if (find(key) != nullptr) {
+			return false;
+		}
+		if (myCapacity == 0 && mySize < INLINE) {
+			myInlineKeys[mySize] = key;
+			myInlineValues[mySize] = value;
+			mySize++;
+			return true;
+		}
+		if ((mySize + 1) * 8 > myCapacity * 7) {
+			grow();
+		}
+		place(key, value);
+		mySize++;
+		return true;
+	}
+
+private:
+	static constexpr size_t INLINE = 8;
+	static constexpr size_t GROUP = 16;
+	static constexpr int8_t Empty = -128;
+
+	struct Slot{
+		Atom key;
+		V value;
+	};
+
+	static uint64_t hash(Atom key) { return (uint64_t)key * 0x9E3779B97F4A7C15ull; }
+	static int8_t tagOf(uint64_t h) { return (int8_t)(h >> 57); }
+	size_t firstGroup(uint64_t h) const { return (h >> 7) & (myCapacity / GROUP - 1); }
+	size_t nextGroup(size_t group) const { return (group + 1) & (myCapacity / GROUP - 1); }
+	static unsigned lowestBit(uint32_t mask) { return __builtin_ctz(mask); }
+
+	// bit i set if inline key i is key
+	uint32_t inlineMatches(Atom key) const {
+#if defined(__SSE2__)
+		__m128i k = _mm_set1_epi32((int)key);
+		__m128i lo = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)myInlineKeys), k);
+		__m128i hi = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(myInlineKeys + 4)), k);
+		uint32_t mask = _mm_movemask_ps(_mm_castsi128_ps(lo))
+		  | _mm_movemask_ps(_mm_castsi128_ps(hi)) << 4;
+#else
+		uint32_t mask = 0;
+		for (unsigned i = 0; i < INLINE; i++) {
+			mask |= (uint32_t)(myInlineKeys[i] == key) << i;
+		}
+#endif
+		return mask & ((1u << mySize) - 1);
+	}
+
+	// bit i set for each control byte i of the group equal to tag
+	static uint32_t matches(const int8_t * control, int8_t tag){
+#if defined(__SSE2__)
+		__m128i bytes = _mm_loadu_si128((const __m128i *)control);
+		return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag)));
+#else
+		uint32_t mask = 0;
+		for (unsigned i = 0; i < GROUP; i++) {
+			mask |= (uint32_t)(control[i] == tag) << i;
+		}
+		return mask;
+#endif
+	}
+	static uint32_t empties(const int8_t * control){
+#if defined(__SSE2__)
+		//Empty is the only control byte with its high bit set
+		return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)control));
+#else
+		return matches(control, Empty);
+#endif
+	}
+
+	// into the first empty slot of key's probe sequence
+	void place(Atom key, V value){
+		uint64_t h = hash(key);
+		for (size_t group = firstGroup(h); ; group = nextGroup(group)) {
+			uint32_t empty = empties(myControl.data() + group * GROUP);
+			if (empty != 0) {
+				size_t i = group * GROUP + lowestBit(empty);
+				myControl[i] = tagOf(h);
+				mySlots[i] = Slot{key, value};
+				return;
+			}
+		}
+	}
+
+	void grow(){
+		std::vector<int8_t> control;
+		std::vector<Slot> slots;
+		control.swap(myControl);
+		slots.swap(mySlots);
+		size_t capacity = myCapacity;
+		myCapacity = capacity == 0 ? 2 * GROUP : capacity * 2;
+		myControl.assign(myCapacity, Empty);
+		mySlots.resize(myCapacity);
+		if (capacity == 0) {
+			for (size_t i = 0; i < mySize; i++) {
+				place(myInlineKeys[i], myInlineValues[i]);
+			}
+			return;
+		}
+		for (size_t i = 0; i < capacity; i++) {
+			if (control[i] != Empty) {
+				place(slots[i].key, slots[i].value);
+			}
+		}
+	}
+
+	size_t mySize = 0;
+	// 0 while the keys are inline
+	size_t myCapacity = 0;
+	Atom myInlineKeys[INLINE] = { };
+	V myInlineValues[INLINE];
+	std::vector<int8_t> myControl;
+	std::vector<Slot> mySlots;
+};
+
+}
+#endif
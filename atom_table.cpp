@@ -0,0 +1,46 @@
+#include <cstring>
+
+#include "atom_table.hpp"
+
+namespace LILC{
+
+static const size_t CHUNK_SIZE = 64 * 1024;
+
+AtomTable& AtomTable::global(){
+	static AtomTable table;
+	return table;
+}
+
+Atom AtomTable::intern(std::string_view text){
+	auto found = myAtoms.find(text);
+	if (found != myAtoms.end()) {
+		return found->second;
+	}
+	std::string_view stored(store(text), text.size());
+	Atom atom = myTexts.size();
+	myTexts.push_back(stored);
+	myAtoms.insert({stored, atom});
+	return atom;
+}
+
+Atom AtomTable::find(std::string_view text) const{
+	auto found = myAtoms.find(text);
+	if (found != myAtoms.end()) {
+		return found->second;
+	}
+	return NoAtom;
+}
+
+const char * AtomTable::store(std::string_view text){
+	if (myChunks.empty() || myChunkSize - myChunkUsed < text.size()) {
+		myChunkSize = text.size() > CHUNK_SIZE ? text.size() : CHUNK_SIZE;
+		myChunks.emplace_back(new char[myChunkSize]);
+		myChunkUsed = 0;
+	}
+	char * dest = myChunks.back().get() + myChunkUsed;
+	memcpy(dest, text.data(), text.size());
+	myChunkUsed += text.size();
+	return dest;
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef LILC_ATOM_TABLE_HPP
+#define LILC_ATOM_TABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace LILC{
+
+//An interned identifier. Two atoms are the same name exactly when
+// they are the same number, so they hash and compare in O(1).
+typedef uint32_t Atom;
+
+//The table of every identifier seen so far. It is shared by the
+// scanner, the AST and the symbol table; text is only looked up again
+// to unparse or report an error.
+class AtomTable{
+public:
+	static const Atom NoAtom = UINT32_MAX;
+
+	// Most code wants the global table; private tables are for
+	// scanning on other threads, to be merged into it afterwards.
+	AtomTable() = default;
+	static AtomTable& global();
+
+	// returns the atom for text, adding it if it's new
+	Atom intern(std::string_view text);
+	// returns NoAtom if text was never interned
+	Atom find(std::string_view text) const;
+	std::string_view text(Atom atom) const { return myTexts[atom]; }
+	size_t size() const { return myTexts.size(); }
+
+private:
+	const char * store(std::string_view text);
+
+	std::unordered_map<std::string_view, Atom> myAtoms;
+	std::vector<std::string_view> myTexts;
+	//interned text lives in fixed-size chunks so views never move
+	std::vector<std::unique_ptr<char[]>> myChunks;
+	size_t myChunkUsed = 0;
+	size_t myChunkSize = 0;
+};
+
+inline std::string_view atomText(Atom atom){
+	return AtomTable::global().text(atom);
+}
+
+}
+#endif
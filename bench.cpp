@@ -0,0 +1,225 @@
+// Front-end throughput: tokens per second for each scanner, AST nodes
+// per second for each parser, eager and lazy, and for unparsing, both
+// for the tree of ASTNodes and for the FlatAST, the bytes each takes
+// per node, and the process's peak RSS. Run it on a corpus from gen_corpus; "make bench"
+// does both.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <streambuf>
+#include <string>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "lilc_compiler.hpp"
+#include "lilc_scanner.hpp"
+#include "fast_scanner.hpp"
+#include "token_cursor.hpp"
+#include "descent_parser.hpp"
+
+using namespace LILC;
+
+// the best of runs timings of work, in seconds
+static double best(int runs, const std::function<void()>& work){
+	double fastest = 0;
+	for (int i = 0; i < runs; i++) {
+		auto start = std::chrono::steady_clock::now();
+		work();
+		std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+		if (i == 0 || took.count() < fastest) {
+			fastest = took.count();
+		}
+	}
+	return fastest;
+}
+
+static void report(const char * what, double seconds, size_t count,
+  const char * unit, size_t bytes){
+	std::printf("  %-20s %9.3f ms %10.2f M%s/s %9.1f MB/s\n", what,
+	  seconds * 1e3, count / seconds / 1e6, unit, bytes / seconds / 1e6);
+}
+
+static size_t peakRSS(){
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss; //KB on Linux
+}
+
+static void scanWith(Lexer * scanner, TokenBuffer * tokens){
+	tokens->clear();
+	scanner->tokenize(tokens);
+	delete scanner;
+}
+
+// an ostream that throws away what it is given, a buffer at a time
+class NullBuffer : public std::streambuf{
+public:
+	NullBuffer() { setp(myBuffer, myBuffer + sizeof(myBuffer)); }
+protected:
+	int overflow(int c) override {
+		setp(myBuffer, myBuffer + sizeof(myBuffer));
+		return c;
+	}
+private:
+	char myBuffer[4096];
+};
+
+// a directory for the AST cache, gone again when this goes
+class TempDirectory{
+public:
+	TempDirectory() {
+		char path[] = "/tmp/lilc_bench.XXXXXX";
+		if (mkdtemp(path) != nullptr) {
+			myPath = path;
+		}
+	}
+	~TempDirectory() {
+		if (DIR * dir = opendir(myPath.c_str())) {
+			while (struct dirent * entry = readdir(dir)) {
+				unlink((myPath + "/" + entry->d_name).c_str());
+			}
+			closedir(dir);
+		}
+		rmdir(myPath.c_str());
+	}
+	const std::string& path() const { return myPath; }
+private:
+	std::string myPath;
+};
+
+static int usage(){
+	std::fprintf(stderr, "Usage: lilc_bench [--runs=N] <infile>...\n");
+	return 1;
+}
+
+int main(int argc, char ** argv){
+	int runs = 5;
+	int arg = 1;
+	for (; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; arg++) {
+		if (std::strncmp(argv[arg], "--runs=", 7) == 0) {
+			runs = std::atoi(argv[arg] + 7);
+		} else {
+			return usage();
+		}
+	}
+	if (arg == argc || runs < 1) {
+		return usage();
+	}
+
+	for (; arg < argc; arg++) {
+		SourceFile source;
+		if (!source.map(argv[arg])) {
+			std::perror(argv[arg]);
+			return 1;
+		}
+		TokenBuffer tokens;
+		tokens.reserve(source.size() / 4);
+
+		double fast = best(runs, [&]{
+			scanWith(new LilC_FastScanner(source.data(), source.size()), &tokens);
+		});
+		double flex = best(runs, [&]{
+			scanWith(new LilC_Scanner(&source), &tokens);
+		});
+
+		// Parse the last scan's tokens, into one arena that is reset
+		// between runs, as the compiler does between inputs. The
+		// compiler only receives the root.
+		LilC_Compiler compiler;
+		TokenCursor cursor(tokens);
+		Arena ast(1 << 20);
+		FlatAST flat;
+		ASTBuilder build(ast);
+		size_t nodes = 0;
+		size_t rss = 0;
+		auto bisonOnce = [&]{
+			cursor.rewind();
+			ast.reset();
+			flat.clear();
+			LilC_Parser parser(cursor, compiler, build);
+			if (parser.parse() != 0) {
+				std::fprintf(stderr, "%s: parse failed\n", argv[arg]);
+				std::exit(1);
+			}
+		};
+		auto descentOnce = [&]{
+			ast.reset();
+			flat.clear();
+			DescentParser parser(tokens, compiler, build);
+			if (parser.parse() != 0) {
+				std::fprintf(stderr, "%s: parse failed\n", argv[arg]);
+				std::exit(1);
+			}
+		};
+		double bison = best(runs, bisonOnce);
+		double descent = best(runs, [&]{
+			size_t before = ASTNode::created();
+			descentOnce();
+			nodes = ASTNode::created() - before;
+			if (rss == 0) {
+				rss = peakRSS();
+			}
+		});
+		size_t treeBytes = ast.bytesReserved();
+		NullBuffer discard;
+		std::ostream out(&discard);
+		double unparse = best(runs, [&]{
+			compiler.getASTRoot()->unparse(out, 0);
+		});
+
+		// Lazily: only the top level, as a query for signatures would,
+		// and then the bodies too, on one thread per core. The compiler
+		// keeps the tokens from its first load of the file.
+		LilC_Compiler lazy;
+		lazy.setLazyBodies(true);
+		lazy.setThreads(0);
+		double topLevel = best(runs, [&]{
+			lazy.parse(argv[arg]);
+		});
+		double lazyAll = best(runs, [&]{
+			lazy.parse(argv[arg]);
+			if (!lazy.parseBodies()) {
+				std::exit(1);
+			}
+		});
+
+		// Through the AST cache: the first parse stores the flat tree,
+		// and the rest only hash the input and load the tree back
+		TempDirectory cacheDir;
+		LilC_Compiler cached;
+		cached.setFlatAST(true);
+		cached.setCacheDirectory(cacheDir.path());
+		cached.parse(argv[arg]);
+		double fromCache = best(runs, [&]{
+			cached.parse(argv[arg]);
+		});
+
+		build.setFlat(&flat);
+		double bisonFlat = best(runs, bisonOnce);
+		double descentFlat = best(runs, descentOnce);
+		double unparseFlat = best(runs, [&]{
+			flat.unparse(out, 0);
+		});
+
+		std::printf("%s: %.1f MB, %zu tokens, %zu AST nodes\n", argv[arg],
+		  source.size() / 1e6, tokens.size(), nodes);
+		report("scan (hand-written)", fast, tokens.size(), "tokens", source.size());
+		report("scan (flex)", flex, tokens.size(), "tokens", source.size());
+		report("parse (bison)", bison, nodes, "nodes", source.size());
+		report("parse (hand-written)", descent, nodes, "nodes", source.size());
+		report("parse (bison, flat)", bisonFlat, flat.size(), "nodes", source.size());
+		report("parse (flat)", descentFlat, flat.size(), "nodes", source.size());
+		report("parse (cached)", fromCache, flat.size(), "nodes", source.size());
+		report("parse (top level)", topLevel, tokens.size(), "tokens", source.size());
+		report("parse (lazy, all)", lazyAll, nodes, "nodes", source.size());
+		report("unparse", unparse, nodes, "nodes", source.size());
+		report("unparse (flat)", unparseFlat, flat.size(), "nodes", source.size());
+		std::printf("  %.1f bytes/node as ASTNodes, %.1f flat\n",
+		  (double)treeBytes / nodes, (double)flat.bytes() / flat.size());
+		std::printf("  peak RSS %zu MB\n", rss / 1024);
+	}
+	return 0;
+}
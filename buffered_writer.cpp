@@ -0,0 +1,89 @@
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "buffered_writer.hpp"
+
+namespace LILC{
+
+BufferedWriter::BufferedWriter(size_t capacity){
+	myCapacity = capacity;
+	myBuffer = new char[capacity];
+}
+
+BufferedWriter::~BufferedWriter(){
+	close();
+	delete[] myBuffer;
+}
+
+bool BufferedWriter::open(const char * filename){
+	close();
+	return open(::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666));
+}
+
+bool BufferedWriter::open(int fd){
+	close();
+	myFd = fd;
+	myWritten = 0;
+	myFailed = false;
+	return myFd >= 0;
+}
+
+bool BufferedWriter::close(){
+	if (myFd < 0) {
+		return !myFailed;
+	}
+	flush();
+	if (::close(myFd) != 0) {
+		myFailed = true;
+	}
+	myFd = -1;
+	return !myFailed;
+}
+
+BufferedWriter& BufferedWriter::operator<<(int value){
+	char digits[16];
+	std::to_chars_result end = std::to_chars(digits, digits + sizeof(digits), value);
+	write(digits, end.ptr - digits);
+	return *this;
+}
+
+void BufferedWriter::flush(){
+	const char * data = myBuffer;
+	size_t left = myUsed;
+	while (left > 0 && myFd >= 0) {
+		ssize_t done = ::write(myFd, data, left);
+		if (done <= 0) {
+			myFailed = true;
+			break;
+		}
+		data += done;
+		left -= done;
+	}
+	myWritten += myUsed;
+	myUsed = 0;
+}
+
+void BufferedWriter::writeSlow(const void * data, size_t length){
+	flush();
+	if (length < myCapacity) {
+		memcpy(myBuffer, data, length);
+		myUsed = length;
+		return;
+	}
+	//too big to be worth buffering; hand it straight over
+	const char * bytes = static_cast<const char *>(data);
+	while (length > 0 && myFd >= 0) {
+		ssize_t done = ::write(myFd, bytes, length);
+		if (done <= 0) {
+			myFailed = true;
+			break;
+		}
+		bytes += done;
+		length -= done;
+		myWritten += done;
+	}
+}
+
+}
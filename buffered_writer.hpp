@@ -0,0 +1,67 @@
+#ifndef LILC_BUFFERED_WRITER_HPP
+#define LILC_BUFFERED_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace LILC{
+
+//Writes to a file through one large buffer, so output costs a system
+// call per buffer-full rather than per line as with std::endl.
+class BufferedWriter{
+public:
+	BufferedWriter(size_t capacity = 1 << 20);
+	~BufferedWriter();
+	BufferedWriter(const BufferedWriter&) = delete;
+	BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+	bool open(const char * filename);
+	// writes to fd, an already open file, which close() closes
+	bool open(int fd);
+	// flushes and closes; returns false if any write failed
+	bool close();
+
+	void write(const void * data, size_t length){
+		if (length > myCapacity - myUsed) {
+			writeSlow(data, length);
+			return;
+		}
+		memcpy(myBuffer + myUsed, data, length);
+		myUsed += length;
+	}
+	void writeU32(uint32_t value){ write(&value, sizeof(value)); }
+
+	BufferedWriter& operator<<(std::string_view text){
+		write(text.data(), text.size());
+		return *this;
+	}
+	BufferedWriter& operator<<(char c){
+		if (myUsed == myCapacity) {
+			flush();
+		}
+		myBuffer[myUsed++] = c;
+		return *this;
+	}
+	BufferedWriter& operator<<(int value);
+
+	void flush();
+	size_t position() const { return myWritten + myUsed; }
+	// whether a write has failed so far; writes still in the buffer
+	// aren't known to until close()
+	bool failed() const { return myFailed; }
+
+private:
+	void writeSlow(const void * data, size_t length);
+
+	int myFd = -1;
+	char * myBuffer;
+	size_t myCapacity;
+	size_t myUsed = 0;
+	size_t myWritten = 0;
+	bool myFailed = false;
+};
+
+}
+#endif
@@ -0,0 +1,428 @@
+
+#include "descent_parser.hpp"
+#include "lilc_compiler.hpp"
+
+namespace LILC{
+
+//Binding of the binary operators, from the precedence declarations in
+// lilc.yy; 0 for every other token. ASSIGN, the loosest, only ever
+// follows a loc, so primary() takes it there, and NOT binds tighter
+// than all of these, so its operand is just a unary().
+enum Precedence{ None, Or, And, Compare, Sum, Product };
+
+static int precedence(int tag){
+	typedef LilC_Parser::token Tok;
+	switch (tag) {
+	case Tok::OR: return Or;
+	case Tok::AND: return And;
+	case Tok::LESS: case Tok::GREATER: case Tok::LESSEQ:
+	case Tok::GREATEREQ: case Tok::EQUALS: case Tok::NOTEQUALS:
+		return Compare;
+	case Tok::PLUS: case Tok::MINUS: return Sum;
+	case Tok::TIMES: case Tok::DIVIDE: return Product;
+	default: return None;
+	}
+}
+
+int DescentParser::parse(){
+	myPos = 0;
+	try {
+		myCompiler.setASTRoot(program());
+	} catch (SyntaxError&) {
+		//at the token bison would have stopped at too, unless a body
+		//skipped before it holds an earlier one
+		uint32_t errorAt = offset();
+		if (myLazy != nullptr) {
+			for (const LazyBody& body : *myLazy) {
+				if (!parseBody(body, &errorAt)) {
+					break;
+				}
+			}
+		}
+		myCompiler.syntaxError(errorAt, "syntax error");
+		return 1;
+	}
+	return 0;
+}
+
+//Locations follow YYLLOC_DEFAULT: a node is at the first token of its
+// rule, and an empty list at the token before it, which for the
+// declList of program is bison's initial location, 0.
+ProgramNode * DescentParser::program(){
+	DeclList * decls = myBuild.handle(myBuild.list<DeclList>(0));
+	while (tag() != Tok::END) {
+		decls = myCompiler.topLevelDecl(myBuild, decls, decl());
+	}
+	return myBuild.make<ProgramNode>(0, myBuild.make<DeclListNode>(0, *decls));
+}
+
+DeclNode * DescentParser::decl(){
+	uint32_t start = offset();
+	if (tag() == Tok::STRUCT) {
+		next();
+		uint32_t nameStart = offset();
+		IdNode * name = id();
+		if (tag() != Tok::LCURLY) {
+			return structTail(start, nameStart, name);
+		}
+		next();
+		uint32_t bodyStart = offset();
+		DeclList body = myBuild.list<DeclList>(bodyStart, varDecl());
+		while (tag() == Tok::INT || tag() == Tok::BOOL || tag() == Tok::VOID
+		  || tag() == Tok::STRUCT) {
+			body = myBuild.append(std::move(body), varDecl());
+		}
+		expect(Tok::RCURLY);
+		expect(Tok::SEMICOLON);
+		return myBuild.make<StructDeclNode>(start, name,
+		  myBuild.make<DeclListNode>(bodyStart, body));
+	}
+	TypeNode * t = type();
+	IdNode * name = id();
+	if (tag() == Tok::SEMICOLON) {
+		next();
+		return myBuild.make<VarDeclNode>(start, t, name, VarDeclNode::NOT_STRUCT);
+	}
+	FormalsListNode * params = formals();
+	FnBodyNode * body = fnBody();
+	return myBuild.make<FnDeclNode>(start, t, name, params, body);
+}
+
+DeclNode * DescentParser::varDecl(){
+	uint32_t start = offset();
+	if (tag() == Tok::STRUCT) {
+		next();
+		uint32_t nameStart = offset();
+		return structTail(start, nameStart, id());
+	}
+	TypeNode * t = type();
+	IdNode * name = id();
+	expect(Tok::SEMICOLON);
+	return myBuild.make<VarDeclNode>(start, t, name, VarDeclNode::NOT_STRUCT);
+}
+
+// the rest of STRUCT id id SEMICOLON, after the struct's name
+DeclNode * DescentParser::structTail(uint32_t start, uint32_t nameStart, IdNode * name){
+	StructNode * t = myBuild.make<StructNode>(nameStart, name);
+	IdNode * var = id();
+	expect(Tok::SEMICOLON);
+	return myBuild.make<VarDeclNode>(start, t, var, 0);
+}
+
+TypeNode * DescentParser::type(){
+	uint32_t start = offset();
+	switch (tag()) {
+	case Tok::INT: next(); return myBuild.make<IntNode>(start);
+	case Tok::BOOL: next(); return myBuild.make<BoolNode>(start);
+	case Tok::VOID: next(); return myBuild.make<VoidNode>(start);
+	default: throw SyntaxError();
+	}
+}
+
+IdNode * DescentParser::id(){
+	const TokenRec& tok = expect(Tok::ID);
+	return myBuild.make<IdNode>(tok.offset, tok.payload);
+}
+
+FormalsListNode * DescentParser::formals(){
+	uint32_t start = expect(Tok::LPAREN).offset;
+	if (tag() == Tok::RPAREN) {
+		next();
+		return myBuild.make<FormalsListNode>(start, myBuild.list<FormalsList>(start));
+	}
+	uint32_t listStart = offset();
+	FormalsList params = myBuild.list<FormalsList>(listStart, formalDecl());
+	while (tag() == Tok::COMMA) {
+		next();
+		params = myBuild.append(std::move(params), formalDecl());
+	}
+	expect(Tok::RPAREN);
+	return myBuild.make<FormalsListNode>(start, params);
+}
+
+FormalDeclNode * DescentParser::formalDecl(){
+	uint32_t start = offset();
+	TypeNode * t = type();
+	return myBuild.make<FormalDeclNode>(start, t, id());
+}
+
+FnBodyNode * DescentParser::fnBody(){
+	size_t token = myPos;
+	uint32_t start = expect(Tok::LCURLY).offset;
+	if (myLazy != nullptr && skipBody()) {
+		//never building a FlatAST here, so straight into the arena
+		FnBodyNode * body = myBuild.nodes().make<FnBodyNode>(nullptr, nullptr);
+		body->setOffset(start);
+		myLazy->push_back(LazyBody{body, token});
+		return body;
+	}
+	DeclList decls = varDeclList(start);
+	StmtList stmts = stmtList(start);
+	expect(Tok::RCURLY);
+	return myBuild.make<FnBodyNode>(start, myBuild.make<DeclListNode>(start, decls),
+	  myBuild.make<StmtListNode>(start, stmts));
+}
+
+bool DescentParser::skipBody(){
+	size_t from = myPos;
+	for (unsigned depth = 1; depth > 0; myPos++) {
+		switch (tag()) {
+		case Tok::LCURLY:
+			depth++;
+			break;
+		case Tok::RCURLY:
+			depth--;
+			break;
+		case Tok::END:
+			//no valid body ends here; let the grammar say where it breaks
+			myPos = from;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DescentParser::parseBody(const LazyBody& body, uint32_t * errorAt){
+	myPos = body.token + 1;
+	uint32_t start = myTokens[body.token].offset;
+	try {
+		DeclList decls = varDeclList(start);
+		StmtList stmts = stmtList(start);
+		expect(Tok::RCURLY);
+		body.node->setBody(myBuild.make<DeclListNode>(start, decls),
+		  myBuild.make<StmtListNode>(start, stmts));
+	} catch (SyntaxError&) {
+		*errorAt = offset();
+		return false;
+	}
+	return true;
+}
+
+DeclList DescentParser::varDeclList(uint32_t brace){
+	DeclList decls = myBuild.list<DeclList>(brace);
+	while (tag() == Tok::INT || tag() == Tok::BOOL || tag() == Tok::VOID
+	  || tag() == Tok::STRUCT) {
+		decls = myBuild.append(std::move(decls), varDecl());
+	}
+	return decls;
+}
+
+StmtList DescentParser::stmtList(uint32_t brace){
+	StmtList stmts = myBuild.list<StmtList>(brace);
+	while (tag() != Tok::RCURLY) {
+		stmts = myBuild.append(std::move(stmts), stmt());
+	}
+	return stmts;
+}
+
+StmtNode * DescentParser::stmt(){
+	uint32_t start = offset();
+	switch (tag()) {
+	case Tok::ID: {
+		IdNode * name = id();
+		if (tag() == Tok::LPAREN) {
+			CallExpNode * call = fncallTail(start, name);
+			expect(Tok::SEMICOLON);
+			return myBuild.make<CallStmtNode>(start, call);
+		}
+		ExpNode * loc = locTail(start, name);
+		StmtNode * result;
+		switch (tag()) {
+		case Tok::ASSIGN: {
+			next();
+			ExpNode * value = exp(Or);
+			result = myBuild.make<AssignStmtNode>(start,
+			  myBuild.make<AssignNode>(start, loc, value));
+			break;
+		}
+		case Tok::PLUSPLUS:
+			next();
+			result = myBuild.make<PostIncStmtNode>(start, loc);
+			break;
+		case Tok::MINUSMINUS:
+			next();
+			result = myBuild.make<PostDecStmtNode>(start, loc);
+			break;
+		default:
+			throw SyntaxError();
+		}
+		expect(Tok::SEMICOLON);
+		return result;
+	}
+	case Tok::INPUT: {
+		next();
+		expect(Tok::READ);
+		uint32_t locStart = offset();
+		ExpNode * loc = locTail(locStart, id());
+		expect(Tok::SEMICOLON);
+		return myBuild.make<ReadStmtNode>(start, loc);
+	}
+	case Tok::OUTPUT: {
+		next();
+		expect(Tok::WRITE);
+		ExpNode * value = exp(Or);
+		expect(Tok::SEMICOLON);
+		return myBuild.make<WriteStmtNode>(start, value);
+	}
+	case Tok::IF:
+	case Tok::WHILE:
+		return conditional(start, next().tag);
+	case Tok::RETURN: {
+		next();
+		if (tag() == Tok::SEMICOLON) {
+			next();
+			return myBuild.make<ReturnStmtNode>(start, nullptr);
+		}
+		ExpNode * value = exp(Or);
+		expect(Tok::SEMICOLON);
+		return myBuild.make<ReturnStmtNode>(start, value);
+	}
+	default:
+		throw SyntaxError();
+	}
+}
+
+// if, if-else and while, from the LPAREN on
+StmtNode * DescentParser::conditional(uint32_t start, int keyword){
+	expect(Tok::LPAREN);
+	ExpNode * cond = exp(Or);
+	expect(Tok::RPAREN);
+	uint32_t brace = expect(Tok::LCURLY).offset;
+	DeclList decls = varDeclList(brace);
+	StmtList stmts = stmtList(brace);
+	expect(Tok::RCURLY);
+	if (keyword == Tok::WHILE) {
+		return myBuild.make<WhileStmtNode>(start, cond,
+		  myBuild.make<DeclListNode>(brace, decls), myBuild.make<StmtListNode>(brace, stmts));
+	}
+	if (tag() != Tok::ELSE) {
+		return myBuild.make<IfStmtNode>(start, cond,
+		  myBuild.make<DeclListNode>(brace, decls), myBuild.make<StmtListNode>(brace, stmts));
+	}
+	next();
+	uint32_t elseBrace = expect(Tok::LCURLY).offset;
+	DeclList elseDecls = varDeclList(elseBrace);
+	StmtList elseStmts = stmtList(elseBrace);
+	expect(Tok::RCURLY);
+	return myBuild.make<IfElseStmtNode>(start, cond,
+	  myBuild.make<DeclListNode>(brace, decls), myBuild.make<StmtListNode>(brace, stmts),
+	  myBuild.make<DeclListNode>(elseBrace, elseDecls),
+	  myBuild.make<StmtListNode>(elseBrace, elseStmts));
+}
+
+//Precedence climbing: the operand on the right of an operator binds at
+// least one level tighter, which makes every level left-associative.
+// The comparisons are nonassoc, so a second one at the same level is an
+// error where bison's table has one.
+ExpNode * DescentParser::exp(int minPrecedence){
+	uint32_t start = offset();
+	ExpNode * lhs = unary();
+	for (int level = precedence(tag()); level != None && level >= minPrecedence;
+	  level = precedence(tag())) {
+		int op = next().tag;
+		ExpNode * rhs = exp(level + 1);
+		lhs = binary(op, start, lhs, rhs);
+		if (level == Compare && precedence(tag()) == Compare) {
+			throw SyntaxError();
+		}
+	}
+	return lhs;
+}
+
+ExpNode * DescentParser::unary(){
+	uint32_t start = offset();
+	switch (tag()) {
+	case Tok::NOT:
+		next();
+		return myBuild.make<NotNode>(start, unary());
+	case Tok::MINUS:
+		next();
+		return myBuild.make<UnaryMinusNode>(start, primary(false));
+	default:
+		return primary(true);
+	}
+}
+
+ExpNode * DescentParser::primary(bool assignment){
+	uint32_t start = offset();
+	switch (tag()) {
+	case Tok::ID: {
+		IdNode * name = id();
+		if (tag() == Tok::LPAREN) {
+			return fncallTail(start, name);
+		}
+		ExpNode * loc = locTail(start, name);
+		if (!assignment || tag() != Tok::ASSIGN) {
+			return loc;
+		}
+		//right-associative and loosest of all: it takes the rest
+		next();
+		ExpNode * value = exp(Or);
+		return myBuild.make<AssignNode>(start, loc, value);
+	}
+	case Tok::INTLITERAL:
+		return myBuild.make<IntLitNode>(start, next().payload);
+	case Tok::STRINGLITERAL:
+		return myBuild.make<StrLitNode>(start,
+		  myBuild.copy(myTokens.stringAt(next().payload)));
+	case Tok::TRUE:
+		next();
+		return myBuild.make<TrueNode>(start);
+	case Tok::FALSE:
+		next();
+		return myBuild.make<FalseNode>(start);
+	case Tok::LPAREN: {
+		next();
+		ExpNode * inner = exp(Or);
+		expect(Tok::RPAREN);
+		return inner;
+	}
+	default:
+		throw SyntaxError();
+	}
+}
+
+ExpNode * DescentParser::locTail(uint32_t start, ExpNode * loc){
+	while (tag() == Tok::DOT) {
+		next();
+		IdNode * field = id();
+		loc = myBuild.make<DotAccessNode>(start, loc, field);
+	}
+	return loc;
+}
+
+CallExpNode * DescentParser::fncallTail(uint32_t start, IdNode * name){
+	expect(Tok::LPAREN);
+	if (tag() == Tok::RPAREN) {
+		next();
+		return myBuild.make<CallExpNode>(start, name,
+		  myBuild.make<ExpListNode>(start, myBuild.list<ExpList>(start)));
+	}
+	uint32_t argsStart = offset();
+	ExpList args = myBuild.list<ExpList>(argsStart, exp(Or));
+	while (tag() == Tok::COMMA) {
+		next();
+		args = myBuild.append(std::move(args), exp(Or));
+	}
+	expect(Tok::RPAREN);
+	return myBuild.make<CallExpNode>(start, name, myBuild.make<ExpListNode>(argsStart, args));
+}
+
+ExpNode * DescentParser::binary(int op, uint32_t start, ExpNode * lhs, ExpNode * rhs){
+	switch (op) {
+	case Tok::OR: return myBuild.make<OrNode>(start, lhs, rhs);
+	case Tok::AND: return myBuild.make<AndNode>(start, lhs, rhs);
+	case Tok::LESS: return myBuild.make<LessNode>(start, lhs, rhs);
+	case Tok::GREATER: return myBuild.make<GreaterNode>(start, lhs, rhs);
+	case Tok::LESSEQ: return myBuild.make<LessEqNode>(start, lhs, rhs);
+	case Tok::GREATEREQ: return myBuild.make<GreaterEqNode>(start, lhs, rhs);
+	case Tok::EQUALS: return myBuild.make<EqualsNode>(start, lhs, rhs);
+	case Tok::NOTEQUALS: return myBuild.make<NotEqualsNode>(start, lhs, rhs);
+	case Tok::PLUS: return myBuild.make<PlusNode>(start, lhs, rhs);
+	case Tok::MINUS: return myBuild.make<MinusNode>(start, lhs, rhs);
+	case Tok::TIMES: return myBuild.make<TimesNode>(start, lhs, rhs);
+	default: return myBuild.make<DivideNode>(start, lhs, rhs);
+	}
+}
+
+}
@@ -0,0 +1,109 @@
+#ifndef LILC_DESCENT_PARSER_HPP
+#define LILC_DESCENT_PARSER_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "ast_builder.hpp"
+#include "grammar.hh"
+#include "token_buffer.hpp"
+
+namespace LILC{
+
+class LilC_Compiler;
+
+//A function body the lazy pass skipped: the FnBodyNode it built with
+// null lists, and the index of the body's LCURLY in the token buffer
+struct LazyBody{
+	FnBodyNode * node;
+	size_t token;
+};
+
+//A hand-written parser for the grammar in lilc.yy: recursive descent for
+// declarations and statements, precedence climbing for expressions. It
+// builds the same tree as LilC_Parser, node for node and offset for
+// offset, through the same ASTBuilder calls in the same order (so it
+// can build a FlatAST too), and rejects the same inputs at the same
+// token. A change to a rule in lilc.yy needs the matching change here.
+// P4 parses with LilC_Parser unless given --descent.
+class DescentParser{
+public:
+	DescentParser(const TokenBuffer& tokens, LilC_Compiler& compiler, ASTBuilder& build)
+	: myTokens(tokens), myCompiler(compiler), myBuild(build) { }
+
+	// Parses the whole buffer and hands the root to the compiler.
+	// Returns 0 on success, like LilC_Parser::parse.
+	int parse();
+
+	// Make parse() only match the braces of each function body, and
+	// append the bodies it skips to lazy; the builder must not be making
+	// a FlatAST. A body whose braces don't match is parsed (and so
+	// rejected) on the spot, and if the top level fails, the bodies
+	// skipped before are parsed to find the first error.
+	void setLazy(std::vector<LazyBody> * lazy) { myLazy = lazy; }
+	// When the buffer holds a window of the input, where the next one
+	// comes from; not with setLazy, which keeps indexes into the buffer
+	void setSource(TokenSource * source) { mySource = source; }
+	// Parses a skipped body into its node, with this parser's builder,
+	// which must not be building a FlatAST. On a syntax error, returns
+	// false with the offending token's offset in errorAt.
+	bool parseBody(const LazyBody& body, uint32_t * errorAt);
+
+private:
+	typedef LilC_Parser::token Tok;
+	struct SyntaxError{ };
+
+	// Each of these first moves on to the next window if the parser
+	// has read to the end of this one. A record next() returns is good
+	// until the next of the three is called.
+	int tag() { fill(); return myTokens[myPos].tag; }
+	uint32_t offset() { fill(); return myTokens[myPos].offset; }
+	const TokenRec& next() { fill(); return myTokens[myPos++]; }
+	void fill(){
+		if (myPos == myTokens.size() && mySource != nullptr && mySource->refill()) {
+			myPos = 0;
+		}
+	}
+	const TokenRec& expect(int tag){
+		if (this->tag() != tag) {
+			throw SyntaxError();
+		}
+		return next();
+	}
+
+	ProgramNode * program();
+	DeclNode * decl();
+	DeclNode * varDecl();
+	DeclNode * structTail(uint32_t start, uint32_t nameStart, IdNode * name);
+	TypeNode * type();
+	IdNode * id();
+	FormalsListNode * formals();
+	FormalDeclNode * formalDecl();
+	FnBodyNode * fnBody();
+	// past the RCURLY matching the LCURLY before, if there is one
+	bool skipBody();
+	// varDeclList and stmtList, which bison locates at the brace before
+	DeclList varDeclList(uint32_t brace);
+	StmtList stmtList(uint32_t brace);
+	StmtNode * stmt();
+	StmtNode * conditional(uint32_t start, int keyword);
+
+	// exp with no operator looser than minPrecedence outside parentheses
+	ExpNode * exp(int minPrecedence);
+	ExpNode * unary();
+	// term, or with assignment an assignExp too
+	ExpNode * primary(bool assignment);
+	ExpNode * locTail(uint32_t start, ExpNode * loc);
+	CallExpNode * fncallTail(uint32_t start, IdNode * name);
+	ExpNode * binary(int op, uint32_t start, ExpNode * lhs, ExpNode * rhs);
+
+	const TokenBuffer& myTokens;
+	LilC_Compiler& myCompiler;
+	ASTBuilder& myBuild;
+	size_t myPos = 0;
+	std::vector<LazyBody> * myLazy = nullptr;
+	TokenSource * mySource = nullptr;
+};
+
+}
+#endif
@@ -0,0 +1,474 @@
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "fast_scanner.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+/* Vector byte classification. Each scan below returns the first byte
+ * in [p, end) that ends the run it is looking at (or end), a whole
+ * vector at a time while there is a whole vector left, then bytewise. */
+#if defined(__AVX2__)
+typedef __m256i Vec;
+static const ptrdiff_t VEC_BYTES = 32;
+static const uint32_t ALL_LANES = 0xFFFFFFFFu;
+static inline Vec vload(const char * p){ return _mm256_loadu_si256((const __m256i *)p); }
+static inline Vec vsplat(char c){ return _mm256_set1_epi8(c); }
+static inline Vec veq(Vec a, Vec b){ return _mm256_cmpeq_epi8(a, b); }
+static inline Vec vor(Vec a, Vec b){ return _mm256_or_si256(a, b); }
+static inline Vec vsub(Vec a, Vec b){ return _mm256_sub_epi8(a, b); }
+static inline Vec vmin(Vec a, Vec b){ return _mm256_min_epu8(a, b); }
+static inline uint32_t vmask(Vec v){ return (uint32_t)_mm256_movemask_epi8(v); }
+#define LILC_SIMD 1
+#elif defined(__SSE2__)
+typedef __m128i Vec;
+static const ptrdiff_t VEC_BYTES = 16;
+static const uint32_t ALL_LANES = 0xFFFFu;
+static inline Vec vload(const char * p){ return _mm_loadu_si128((const __m128i *)p); }
+static inline Vec vsplat(char c){ return _mm_set1_epi8(c); }
+static inline Vec veq(Vec a, Vec b){ return _mm_cmpeq_epi8(a, b); }
+static inline Vec vor(Vec a, Vec b){ return _mm_or_si128(a, b); }
+static inline Vec vsub(Vec a, Vec b){ return _mm_sub_epi8(a, b); }
+static inline Vec vmin(Vec a, Vec b){ return _mm_min_epu8(a, b); }
+static inline uint32_t vmask(Vec v){ return (uint32_t)_mm_movemask_epi8(v); }
+#define LILC_SIMD 1
+#endif
+
+#ifdef LILC_SIMD
+//lanes holding lo <= c <= hi
+static inline Vec vrange(Vec v, char lo, char hi){
+	Vec d = vsub(v, vsplat(lo));
+	return veq(vmin(d, vsplat(hi - lo)), d);
+}
+#endif
+
+static inline bool isBlank(unsigned char c){
+	return c == ' ' || c == '\t';
+}
+
+static inline bool isIdentStart(unsigned char c){
+	return (unsigned)((c | 0x20) - 'a') < 26 || c == '_';
+}
+
+static inline bool isIdentChar(unsigned char c){
+	return isIdentStart(c) || (unsigned)(c - '0') < 10;
+}
+
+//ESCAPEDCHAR in lilc.l
+static inline bool isEscapable(unsigned char c){
+	return c == 'n' || c == 't' || c == '\'' || c == '"' || c == '?' || c == '\\';
+}
+
+static const char * skipBlanks(const char * p, const char * end){
+#ifdef LILC_SIMD
+	const Vec space = vsplat(' ');
+	const Vec tab = vsplat('\t');
+	for (; end - p >= VEC_BYTES; p += VEC_BYTES) {
+		Vec v = vload(p);
+		uint32_t stops = ~vmask(vor(veq(v, space), veq(v, tab))) & ALL_LANES;
+		if (stops != 0) {
+			return p + __builtin_ctz(stops);
+		}
+	}
+#endif
+	while (p < end && isBlank(*p)) {
+		p++;
+	}
+	return p;
+}
+
+static const char * findNewline(const char * p, const char * end){
+#ifdef LILC_SIMD
+	const Vec newline = vsplat('\n');
+	for (; end - p >= VEC_BYTES; p += VEC_BYTES) {
+		uint32_t stops = vmask(veq(vload(p), newline));
+		if (stops != 0) {
+			return p + __builtin_ctz(stops);
+		}
+	}
+#endif
+	while (p < end && *p != '\n') {
+		p++;
+	}
+	return p;
+}
+
+static const char * skipIdentChars(const char * p, const char * end){
+	//most identifiers are short; don't pay for a vector load on them
+	if (p < end && !isIdentChar(*p)) {
+		return p;
+	}
+#ifdef LILC_SIMD
+	const Vec lowerBit = vsplat(0x20);
+	const Vec underscore = vsplat('_');
+	for (; end - p >= VEC_BYTES; p += VEC_BYTES) {
+		Vec v = vload(p);
+		Vec ident = vor(vrange(vor(v, lowerBit), 'a', 'z'),
+		  vor(vrange(v, '0', '9'), veq(v, underscore)));
+		uint32_t stops = ~vmask(ident) & ALL_LANES;
+		if (stops != 0) {
+			return p + __builtin_ctz(stops);
+		}
+	}
+#endif
+	while (p < end && isIdentChar(*p)) {
+		p++;
+	}
+	return p;
+}
+
+//The next byte a string literal body can't simply run over
+static const char * findStringStop(const char * p, const char * end){
+#ifdef LILC_SIMD
+	const Vec quote = vsplat('"');
+	const Vec backslash = vsplat('\\');
+	const Vec newline = vsplat('\n');
+	for (; end - p >= VEC_BYTES; p += VEC_BYTES) {
+		Vec v = vload(p);
+		uint32_t stops = vmask(vor(veq(v, quote), vor(veq(v, backslash), veq(v, newline))));
+		if (stops != 0) {
+			return p + __builtin_ctz(stops);
+		}
+	}
+#endif
+	while (p < end && *p != '"' && *p != '\\' && *p != '\n') {
+		p++;
+	}
+	return p;
+}
+
+//Matches ({NOTNEWLINEORQUOTEORESCAPE}|\\{ESCAPEDCHAR})* from p
+static const char * skipStringBody(const char * p, const char * end){
+	while (true) {
+		p = findStringStop(p, end);
+		if (end - p >= 2 && *p == '\\' && isEscapable(p[1])) {
+			p += 2;
+			continue;
+		}
+		return p;
+	}
+}
+
+struct Keyword{
+	const char * text;
+	size_t length;
+	int tag;
+};
+
+//Indexed by keywordHash; every keyword lands in its own slot
+static const Keyword KEYWORDS[16] = {
+	{ "true", 4, TokenTag::TRUE },
+	{ "else", 4, TokenTag::ELSE },
+	{ nullptr, 0, 0 },
+	{ "false", 5, TokenTag::FALSE },
+	{ "while", 5, TokenTag::WHILE },
+	{ "output", 6, TokenTag::OUTPUT },
+	{ "bool", 4, TokenTag::BOOL },
+	{ nullptr, 0, 0 },
+	{ "return", 6, TokenTag::RETURN },
+	{ "struct", 6, TokenTag::STRUCT },
+	{ "void", 4, TokenTag::VOID },
+	{ "if", 2, TokenTag::IF },
+	{ "int", 3, TokenTag::INT },
+	{ nullptr, 0, 0 },
+	{ "input", 5, TokenTag::INPUT },
+	{ nullptr, 0, 0 },
+};
+
+static inline size_t keywordHash(const char * p, size_t length){
+	return ((unsigned char)p[0] + 8 * (unsigned char)p[length - 1] + length) & 15;
+}
+
+static inline int lookupKeyword(const char * p, size_t length){
+	if (length < 2 || length > 6) {
+		return 0;
+	}
+	const Keyword& kw = KEYWORDS[keywordHash(p, length)];
+	if (kw.length == length && memcmp(kw.text, p, length) == 0) {
+		return kw.tag;
+	}
+	return 0;
+}
+
+LilC_FastScanner::LilC_FastScanner(const char * text, size_t size){
+	reset(text, size);
+}
+
+void LilC_FastScanner::reset(const char * text, size_t size){
+	myBegin = text;
+	myPos = text;
+	myEnd = text + size;
+	myTokOffset = 0;
+	myTokLength = 0;
+	myTokValue = 0;
+	restart();
+}
+
+int LilC_FastScanner::yylex(Token ** const token){
+	int tag = next();
+	switch (tag) {
+	case TokenTag::END:
+		break;
+	case TokenTag::ID:
+		*token = new IDToken(myTokOffset, myTokValue);
+		break;
+	case TokenTag::INTLITERAL:
+		*token = new IntLitToken(myTokOffset, (int)myTokValue);
+		break;
+	case TokenTag::STRINGLITERAL:
+		*token = new StringLitToken(myTokOffset,
+		  std::string_view(myBegin + myTokOffset, myTokLength));
+		break;
+	default:
+		*token = new NullaryToken(myTokOffset, tag);
+		break;
+	}
+	return tag;
+}
+
+void LilC_FastScanner::tokenize(TokenBuffer * out){
+	int tag;
+	while ((tag = next()) != TokenTag::END) {
+		push(out, tag);
+	}
+	out->push(TokenTag::END, myPos - myBegin);
+}
+
+bool LilC_FastScanner::tokenize(TokenBuffer * out, size_t bytes){
+	const char * stop = (size_t)(myEnd - myPos) > bytes ? myPos + bytes : myEnd;
+	do {
+		int tag = next();
+		if (tag == TokenTag::END) {
+			out->push(TokenTag::END, myPos - myBegin);
+			return false;
+		}
+		push(out, tag);
+	} while (myPos < stop);
+	return true;
+}
+
+void LilC_FastScanner::push(TokenBuffer * out, int tag){
+	uint32_t payload = 0;
+	if (tag == TokenTag::ID || tag == TokenTag::INTLITERAL) {
+		payload = myTokValue;
+	} else if (tag == TokenTag::STRINGLITERAL) {
+		payload = out->addString(std::string_view(myBegin + myTokOffset, myTokLength));
+	}
+	out->push(tag, myTokOffset, payload);
+}
+
+int LilC_FastScanner::produce(int tag, size_t length){
+	myTokOffset = myPos - myBegin;
+	myTokLength = length;
+	charNum += length;
+	myPos += length;
+	return tag;
+}
+
+int LilC_FastScanner::next(){
+	while (myPos < myEnd) {
+		unsigned char c = *myPos;
+		char c2 = myEnd - myPos >= 2 ? myPos[1] : '\0';
+		switch (c) {
+		case ' ':
+		case '\t': {
+			const char * stop = skipBlanks(myPos + 1, myEnd);
+			charNum += stop - myPos;
+			myPos = stop;
+			continue;
+		}
+		case '\n':
+			lineNum++;
+			charNum = 1;
+			myPos++;
+			continue;
+		case '#':
+			//comments don't move charNum; see lilc.l
+			myPos = findNewline(myPos + 1, myEnd);
+			continue;
+		case '/':
+			if (c2 == '/') {
+				myPos = findNewline(myPos + 2, myEnd);
+				continue;
+			}
+			return produce(TokenTag::DIVIDE, 1);
+		case '"': {
+			int tag = scanString();
+			if (tag >= 0) {
+				return tag;
+			}
+			continue;
+		}
+		case '{': return produce(TokenTag::LCURLY, 1);
+		case '}': return produce(TokenTag::RCURLY, 1);
+		case '(': return produce(TokenTag::LPAREN, 1);
+		case ')': return produce(TokenTag::RPAREN, 1);
+		case ';': return produce(TokenTag::SEMICOLON, 1);
+		case ',': return produce(TokenTag::COMMA, 1);
+		case '.': return produce(TokenTag::DOT, 1);
+		case '*': return produce(TokenTag::TIMES, 1);
+		case '<':
+			if (c2 == '<') return produce(TokenTag::WRITE, 2);
+			if (c2 == '=') return produce(TokenTag::LESSEQ, 2);
+			return produce(TokenTag::LESS, 1);
+		case '>':
+			if (c2 == '>') return produce(TokenTag::READ, 2);
+			if (c2 == '=') return produce(TokenTag::GREATEREQ, 2);
+			return produce(TokenTag::GREATER, 1);
+		case '+':
+			if (c2 == '+') return produce(TokenTag::PLUSPLUS, 2);
+			return produce(TokenTag::PLUS, 1);
+		case '-':
+			if (c2 == '-') return produce(TokenTag::MINUSMINUS, 2);
+			return produce(TokenTag::MINUS, 1);
+		case '=':
+			if (c2 == '=') return produce(TokenTag::EQUALS, 2);
+			return produce(TokenTag::ASSIGN, 1);
+		case '!':
+			if (c2 == '=') return produce(TokenTag::NOTEQUALS, 2);
+			return produce(TokenTag::NOT, 1);
+		case '&':
+			if (c2 == '&') return produce(TokenTag::AND, 2);
+			break;
+		case '|':
+			if (c2 == '|') return produce(TokenTag::OR, 2);
+			break;
+		default:
+			if (isIdentStart(c)) {
+				return scanIdentifier();
+			}
+			if ((unsigned)(c - '0') < 10) {
+				return scanIntLiteral();
+			}
+			break;
+		}
+		std::string msg = "Illegal character ";
+		if (c != '\0') {
+			//flex appends yytext as a C string
+			msg += (char)c;
+		}
+		error(lineNum, charNum, msg);
+		charNum += 1;
+		myPos++;
+	}
+	return TokenTag::END;
+}
+
+int LilC_FastScanner::scanIdentifier(){
+	size_t length = skipIdentChars(myPos + 1, myEnd) - myPos;
+	int keyword = lookupKeyword(myPos, length);
+	if (keyword != 0) {
+		return produce(keyword, length);
+	}
+	myTokValue = myAtoms->intern(std::string_view(myPos, length));
+	return produce(TokenTag::ID, length);
+}
+
+int LilC_FastScanner::scanIntLiteral(){
+	const char * stop = myPos + 1;
+	while (stop < myEnd && (unsigned)(*stop - '0') < 10) {
+		stop++;
+	}
+	size_t length = stop - myPos;
+	int value = 0;
+	if (length < 10) {
+		for (const char * p = myPos; p < stop; p++) {
+			value = value * 10 + (*p - '0');
+		}
+	} else {
+		//Could be out of range; do exactly what the flex rule does
+		std::string digits(myPos, length);
+		double overflow = std::stod(digits);
+		value = atoi(digits.c_str());
+		if (overflow > INT_MAX) {
+			std::string msg = "Integer literal too large;"
+			" using max value";
+			warn(0, 0, msg);
+			value = INT_MAX;
+		}
+	}
+	myTokValue = value;
+	return produce(TokenTag::INTLITERAL, length);
+}
+
+/* lilc.l has four overlapping string-literal rules. flex takes the
+ * longest match among them, the earliest rule on a tie, so work out how
+ * far each one would get and do the same. All of them share the prefix
+ * "body, where body stops at p on a quote, newline, end of input, or a
+ * backslash that doesn't start an escape. */
+int LilC_FastScanner::scanString(){
+	const char * s = myPos;
+	const char * p = skipStringBody(s + 1, myEnd);
+	bool backslashAtP = p < myEnd && *p == '\\';
+
+	// "body"
+	size_t good = (p < myEnd && *p == '"') ? p + 1 - s : 0;
+	// "body
+	size_t unterminated = p - s;
+	// "body\X[^\n"]*"
+	size_t badEscape = 0;
+	// "body(\X)?body\?
+	size_t badUnterminated = p - s + backslashAtP;
+	if (backslashAtP && myEnd - p >= 2 && p[1] != '\n') {
+		const char * q = p + 2;
+		while (q < myEnd && *q != '\n' && *q != '"') {
+			q++;
+		}
+		if (q < myEnd && *q == '"') {
+			badEscape = q + 1 - s;
+		}
+		const char * r = skipStringBody(p + 2, myEnd);
+		size_t length = r - s + (r < myEnd && *r == '\\');
+		if (length > badUnterminated) {
+			badUnterminated = length;
+		}
+	}
+
+	size_t length = good;
+	int rule = 1;
+	if (unterminated > length) {
+		length = unterminated;
+		rule = 2;
+	}
+	if (badEscape > length) {
+		length = badEscape;
+		rule = 3;
+	}
+	if (badUnterminated > length) {
+		length = badUnterminated;
+		rule = 4;
+	}
+
+	switch (rule) {
+	case 1:
+		return produce(TokenTag::STRINGLITERAL, length);
+	case 2:
+		error(lineNum, charNum, "unterminated string literal ignored");
+		charNum += length;
+		myPos += length;
+		return TokenTag::END;
+	case 3:
+		error(lineNum, charNum, "string literal with bad escaped character ignored");
+		charNum += length;
+		myPos += length;
+		return TokenTag::END;
+	default: {
+		std::string msg = "unterminated string literal with bad"
+		"escaped character ignored";
+		charNum += length;
+		myPos += length;
+		error(lineNum, charNum, msg);
+		return -1;
+	}
+	}
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef LILC_FAST_SCANNER_HPP
+#define LILC_FAST_SCANNER_HPP
+
+#include <cstdint>
+#include <string_view>
+
+#include "lexer.hpp"
+
+namespace LILC{
+
+//A hand-written replacement for the flex scanner in lilc.l. It works
+// directly over an in-memory copy of the input (usually a mapped
+// SourceFile), skips blanks and comments and finds the ends of
+// identifiers and string literals 16 bytes at a time with SSE2 (32 with
+// AVX2, when built with -mavx2), and recognizes keywords with a perfect
+// hash instead of a DFA.
+//
+// It must agree with LilC_Scanner token for token and diagnostic for
+// diagnostic, including the odd corners of the string-literal rules.
+// P4 scans with the flex scanner unless given --fast-scanner.
+class LilC_FastScanner : public Lexer{
+public:
+	LilC_FastScanner(const char * text = "", size_t size = 0);
+	// Start over on another input
+	void reset(const char * text, size_t size);
+
+	int yylex(Token ** const token);
+	void tokenize(TokenBuffer * out);
+	bool tokenize(TokenBuffer * out, size_t bytes);
+
+	// Intern identifiers into atoms instead of the global table
+	void setAtoms(AtomTable * atoms) { myAtoms = atoms; }
+
+private:
+	// Scans the next token and returns its tag, filling in the
+	// my* fields below. Returns END at the end of input and, like
+	// the flex rules, on a rejected string literal.
+	int next();
+	// Appends the token next() found to out
+	void push(TokenBuffer * out, int tag);
+	int produce(int tag, size_t length);
+	int scanIdentifier();
+	int scanIntLiteral();
+	// Returns -1 if the literal was reported and skipped
+	int scanString();
+
+	const char * myBegin;
+	const char * myPos;
+	const char * myEnd;
+
+	//the most recent token
+	size_t myTokOffset = 0;
+	size_t myTokLength = 0;
+	uint32_t myTokValue = 0;
+
+	AtomTable * myAtoms = &AtomTable::global();
+};
+
+}
+#endif
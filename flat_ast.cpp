@@ -0,0 +1,242 @@
+#include <cstring>
+#include <iostream>
+
+#include "flat_ast.hpp"
+
+namespace LILC{
+
+void FlatAST::clear(){
+	myTags.clear();
+	myOffsets.clear();
+	myFirst.clear();
+	mySecond.clear();
+	myExtra.clear();
+	myStrings.clear();
+	myRoot = NoNode;
+	myStack.clear();
+	myOpen.clear();
+	myItems.clear();
+	myEntries.clear();
+}
+
+size_t FlatAST::bytes() const {
+	return myTags.capacity() * sizeof(Tag)
+	  + (myOffsets.capacity() + myFirst.capacity() + mySecond.capacity()) * sizeof(uint32_t)
+	  + myExtra.capacity() * sizeof(Node)
+	  + myStrings.capacity() * sizeof(std::string_view);
+}
+
+FlatAST::Node FlatAST::node(Tag tag, uint32_t offset, unsigned children){
+	Node taken[5];
+	for (unsigned i = children; i-- > 0; ) {
+		taken[i] = myStack.back();
+		myStack.pop_back();
+		//lists are closed newest first, as they were opened
+		if (!myOpen.empty() && myOpen.back().list == taken[i]) {
+			closeList(taken[i]);
+		}
+	}
+	Node n;
+	if (children > 2) {
+		n = add(tag, offset, myExtra.size(), children);
+		myExtra.insert(myExtra.end(), taken, taken + children);
+	} else {
+		n = add(tag, offset, children > 0 ? taken[0] : NoNode,
+		  children > 1 ? taken[1] : NoNode);
+	}
+	if (tag == Tag::Program) {
+		myRoot = n;
+	}
+	myStack.push_back(n);
+	return n;
+}
+
+void FlatAST::openList(Tag tag, uint32_t offset, unsigned items){
+	Node list = add(tag, offset, 0, 0);
+	myOpen.push_back(OpenList{list, myItems.size()});
+	myItems.insert(myItems.end(), myStack.end() - items, myStack.end());
+	myStack.resize(myStack.size() - items);
+	myStack.push_back(list);
+}
+
+void FlatAST::closeList(Node list){
+	size_t start = myOpen.back().start;
+	myFirst[list] = myExtra.size();
+	mySecond[list] = myItems.size() - start;
+	myExtra.insert(myExtra.end(), myItems.begin() + start, myItems.end());
+	myItems.resize(start);
+	myOpen.pop_back();
+}
+
+uint32_t FlatAST::addString(std::string_view text){
+	myStrings.push_back(text);
+	return myStrings.size() - 1;
+}
+
+void FlatAST::write(BufferedWriter& out) const {
+	//Renumber atoms densely, in first-use order, as token files do
+	std::vector<uint32_t> fileAtom(AtomTable::global().size(), UINT32_MAX);
+	std::vector<Atom> atoms;
+	for (Node n = 0; n < size(); n++) {
+		if (myTags[n] == Tag::Id && fileAtom[myFirst[n]] == UINT32_MAX) {
+			fileAtom[myFirst[n]] = atoms.size();
+			atoms.push_back(myFirst[n]);
+		}
+	}
+
+	out.writeU32(size());
+	out.writeU32(myExtra.size());
+	out.writeU32(atoms.size());
+	out.writeU32(myStrings.size());
+	out.writeU32(myRoot);
+	out.write(myTags.data(), size());
+	static const char padding[4] = { };
+	out.write(padding, -size() & 3);
+	out.write(myOffsets.data(), size() * sizeof(uint32_t));
+	for (Node n = 0; n < size(); n++) {
+		out.writeU32(myTags[n] == Tag::Id ? fileAtom[myFirst[n]] : myFirst[n]);
+	}
+	out.write(mySecond.data(), size() * sizeof(uint32_t));
+	out.write(myExtra.data(), myExtra.size() * sizeof(Node));
+	for (Atom atom : atoms) {
+		std::string_view text = atomText(atom);
+		out.writeU32(text.size());
+		out << text;
+	}
+	for (std::string_view text : myStrings) {
+		out.writeU32(text.size());
+		out << text;
+	}
+}
+
+//Reads from a mapped tree, watching for the end of it
+class FlatASTReader{
+public:
+	FlatASTReader(const char * data, size_t size) : myPos(data), myEnd(data + size) { }
+	bool u32(uint32_t * value){
+		return bytes(value, sizeof(*value));
+	}
+	template<typename T>
+	bool array(std::vector<T> * values, size_t count){
+		//checked before resizing, so a bad count can't ask for more
+		//memory than the file could fill
+		if ((size_t)(myEnd - myPos) / sizeof(T) < count) {
+			return false;
+		}
+		values->resize(count);
+		return bytes(values->data(), count * sizeof(T));
+	}
+	bool text(std::string_view * value){
+		uint32_t length;
+		if (!u32(&length) || (size_t)(myEnd - myPos) < length) {
+			return false;
+		}
+		*value = std::string_view(myPos, length);
+		myPos += length;
+		return true;
+	}
+	bool skip(size_t count){
+		if ((size_t)(myEnd - myPos) < count) {
+			return false;
+		}
+		myPos += count;
+		return true;
+	}
+	bool atEnd() const { return myPos == myEnd; }
+	size_t remaining() const { return myEnd - myPos; }
+private:
+	bool bytes(void * dest, size_t count){
+		if ((size_t)(myEnd - myPos) < count) {
+			return false;
+		}
+		memcpy(dest, myPos, count);
+		myPos += count;
+		return true;
+	}
+	const char * myPos;
+	const char * myEnd;
+};
+
+bool FlatAST::read(const char * data, size_t size){
+	clear();
+	FlatASTReader in(data, size);
+	uint32_t nodes, extra, atomCount, stringCount, root;
+	if (!in.u32(&nodes) || !in.u32(&extra) || !in.u32(&atomCount)
+	  || !in.u32(&stringCount) || !in.u32(&root)) {
+		return false;
+	}
+	if (!in.array(&myTags, nodes) || !in.skip(-nodes & 3)
+	  || !in.array(&myOffsets, nodes) || !in.array(&myFirst, nodes)
+	  || !in.array(&mySecond, nodes) || !in.array(&myExtra, extra)) {
+		clear();
+		return false;
+	}
+	//each atom and string takes at least its length word
+	if (in.remaining() / 4 < (uint64_t)atomCount + stringCount) {
+		clear();
+		return false;
+	}
+	std::vector<Atom> atoms(atomCount);
+	for (Atom& atom : atoms) {
+		std::string_view text;
+		if (!in.text(&text)) {
+			clear();
+			return false;
+		}
+		atom = AtomTable::global().intern(text);
+	}
+	myStrings.resize(stringCount);
+	for (std::string_view& text : myStrings) {
+		if (!in.text(&text)) {
+			clear();
+			return false;
+		}
+	}
+	for (Node n = 0; n < nodes; n++) {
+		if (myTags[n] == Tag::Id) {
+			if (myFirst[n] >= atomCount) {
+				clear();
+				return false;
+			}
+			myFirst[n] = atoms[myFirst[n]];
+		} else if (myTags[n] == Tag::StrLit && myFirst[n] >= stringCount) {
+			clear();
+			return false;
+		}
+	}
+	if (!in.atEnd() || root >= nodes || myTags[root] != Tag::Program) {
+		clear();
+		return false;
+	}
+	myRoot = root;
+	return true;
+}
+
+void FlatAST::reportError(Node n, std::string error, std::string id){
+	size_t line, column;
+	if (myLines != nullptr && myLines->position(offset(n), &line, &column)) {
+		std::cout << line << ":" << column;
+	}
+	std::cout << " ***ERROR*** " << error << ": " << id << "\n";
+}
+
+const Type * FlatAST::typeOf(Node n){
+	switch (tag(n)) {
+	case Tag::Int: return TypeTable::global().intType();
+	case Tag::Bool: return TypeTable::global().boolType();
+	case Tag::Void: return TypeTable::global().voidType();
+	case Tag::Struct: return TypeTable::global().structType(atom(first(n)));
+	case Tag::FormalDecl: return typeOf(first(n));
+	default: return TypeTable::global().none();
+	}
+}
+
+std::vector<const Type *> FlatAST::formalTypes(Node n){
+	std::vector<const Type *> result;
+	for (const Node * it = begin(n); it != end(n); ++it) {
+		result.push_back(typeOf(*it));
+	}
+	return result;
+}
+
+}
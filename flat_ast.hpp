@@ -0,0 +1,161 @@
+#ifndef LILC_FLAT_AST_HPP
+#define LILC_FLAT_AST_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "atom_table.hpp"
+#include "buffered_writer.hpp"
+#include "line_table.hpp"
+#include "symbol_table.hpp"
+
+namespace LILC{
+
+//The AST as parallel arrays instead of a tree of ASTNodes: node n is
+// myTags[n], myOffsets[n] and two operands, myFirst[n] and mySecond[n],
+// whose meaning depends on the tag:
+//
+//  - leaves keep their payload in first: the atom of an Id, the value
+//    of an IntLit, an index into myStrings for a StrLit;
+//  - nodes with one or two children keep them in first and second
+//    (the one child of a ReturnStmt may be NoNode);
+//  - FnDecl, IfStmt, IfElseStmt and WhileStmt keep their children in
+//    myExtra, starting at first, in ASTNode constructor order;
+//  - lists keep their items in myExtra too: second of them, from first.
+//
+// That is 13 bytes a node, plus 4 per list item, with no vtable and
+// no allocation per node. Name analysis and unparse switch on the tag
+// instead of making virtual calls. The parser builds it through an
+// ASTBuilder, in place of the ASTNode tree.
+class FlatAST{
+public:
+	enum class Tag : uint8_t {
+		Program, DeclList, VarDecl, FnDecl, FormalsList, FormalDecl,
+		StructDecl, FnBody, StmtList, ExpList,
+		Int, Bool, Void, Struct,
+		Id, IntLit, StrLit, True, False, DotAccess, Assign, CallExp,
+		UnaryMinus, Not, Plus, Minus, Times, Divide, And, Or,
+		Equals, NotEquals, Less, Greater, LessEq, GreaterEq,
+		AssignStmt, PostIncStmt, PostDecStmt, ReadStmt, WriteStmt,
+		IfStmt, IfElseStmt, WhileStmt, CallStmt, ReturnStmt
+	};
+	typedef uint32_t Node;
+	static constexpr Node NoNode = UINT32_MAX;
+
+	// Forget every node, keeping the storage for the next parse
+	void clear();
+
+	size_t size() const { return myTags.size(); }
+	// the ProgramNode, or NoNode if the last parse failed
+	Node root() const { return myRoot; }
+	// bytes held by the arrays
+	size_t bytes() const;
+
+	Tag tag(Node n) const { return myTags[n]; }
+	uint32_t offset(Node n) const { return myOffsets[n]; }
+	Node first(Node n) const { return myFirst[n]; }
+	Node second(Node n) const { return mySecond[n]; }
+	// the i'th child of a FnDecl, IfStmt, IfElseStmt or WhileStmt
+	Node child(Node n, size_t i) const { return myExtra[myFirst[n] + i]; }
+	// the items of a list
+	const Node * begin(Node n) const { return myExtra.data() + myFirst[n]; }
+	const Node * end(Node n) const { return begin(n) + mySecond[n]; }
+
+	Atom atom(Node n) const { return myFirst[n]; }
+	int value(Node n) const { return (int)myFirst[n]; }
+	std::string_view string(Node n) const { return myStrings[myFirst[n]]; }
+
+	// Building, in the order the parser reduces: each node takes its
+	// children from the top of a stack of finished nodes and leaves
+	// itself there. A list is a node from when it is opened; its items
+	// go into it one at a time and it is closed when a parent takes it.
+	Node leaf(Tag tag, uint32_t offset, uint32_t payload){
+		Node n = add(tag, offset, payload, NoNode);
+		myStack.push_back(n);
+		return n;
+	}
+	Node node(Tag tag, uint32_t offset, unsigned children);
+	// starting with the top items nodes
+	void openList(Tag tag, uint32_t offset, unsigned items = 0);
+	// moves the top node into the newest open list
+	void append(){
+		myItems.push_back(myStack.back());
+		myStack.pop_back();
+	}
+	// text must outlive the tree
+	uint32_t addString(std::string_view text);
+
+	// The binary form ASTCache keeps trees in. Integers are 32-bit in
+	// host byte order:
+	//
+	//   node count, extra count, atom count, string count, root
+	//   each node's tag, a byte each, padded to a multiple of 4
+	//   each node's offset, then each first, then each second
+	//   the extra array
+	//   each atom:   length, bytes
+	//   each string: length, bytes
+	//
+	// An Id's first indexes the file's own atom list (it is interned
+	// again on load), a StrLit's the string list.
+	void write(BufferedWriter& out) const;
+	// Replaces this tree with the one in data; returns false if data is
+	// malformed. Strings point into data, which must outlive the tree.
+	bool read(const char * data, size_t size);
+
+	// Same results, diagnostics and output as ProgramNode's
+	bool nameAnalysis(SymbolTable * symTab, LineTable * lines);
+	void unparse(std::ostream& out, int indent);
+
+private:
+	Node add(Tag tag, uint32_t offset, uint32_t first, uint32_t second){
+		Node n = myTags.size();
+		myTags.push_back(tag);
+		myOffsets.push_back(offset);
+		myFirst.push_back(first);
+		mySecond.push_back(second);
+		return n;
+	}
+	void closeList(Node list);
+
+	bool analyze(Node n, SymbolTable * symTab);
+	bool analyzeVarDecl(Node n, SymbolTable * symTab);
+	bool analyzeStructDecl(Node n, SymbolTable * symTab);
+	bool analyzeDotAccess(Node n, SymbolTable * symTab);
+	bool analyzeList(Node n, SymbolTable * symTab);
+	// TypeNode::getType and FormalsListNode::getTypes
+	const Type * typeOf(Node n);
+	std::vector<const Type *> formalTypes(Node n);
+	void reportError(Node n, std::string error, std::string id);
+
+	void unparse(std::ostream& out, Node n, int indent);
+	void unparseList(std::ostream& out, Node n, int indent, const char * separator);
+
+	std::vector<Tag> myTags;
+	std::vector<uint32_t> myOffsets;
+	std::vector<uint32_t> myFirst;
+	std::vector<uint32_t> mySecond;
+	std::vector<Node> myExtra;
+	std::vector<std::string_view> myStrings;
+	Node myRoot = NoNode;
+
+	// while building: finished nodes not yet taken by a parent, and
+	// the open lists with the items they have so far
+	struct OpenList{
+		Node list;
+		size_t start; //in myItems
+	};
+	std::vector<Node> myStack;
+	std::vector<OpenList> myOpen;
+	std::vector<Node> myItems;
+
+	// what an IdNode's myEntry or a DotAccessNode's structEntry would
+	// hold, by node; filled in by nameAnalysis
+	std::vector<SymbolTableEntry *> myEntries;
+	LineTable * myLines = nullptr;
+};
+
+}
+#endif
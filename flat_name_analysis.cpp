@@ -0,0 +1,206 @@
+#include "flat_ast.hpp"
+
+namespace LILC{
+
+//Each case does what the ASTNode of that tag does in name_analysis.cpp,
+// quirks included, so that the two agree on every diagnostic.
+
+bool FlatAST::nameAnalysis(SymbolTable * symTab, LineTable * lines){
+	myLines = lines;
+	myEntries.assign(size(), nullptr);
+	symTab->addScope();
+	return analyze(first(myRoot), symTab);
+}
+
+bool FlatAST::analyzeList(Node n, SymbolTable * symTab){
+	bool result = true;
+	for (const Node * it = begin(n); it != end(n); ++it) {
+		result = result && analyze(*it, symTab);
+	}
+	return result;
+}
+
+bool FlatAST::analyzeVarDecl(Node n, SymbolTable * symTab){
+	Node type = first(n);
+	Node id = second(n);
+	if (tag(type) != Tag::Struct) {
+		bool result = symTab->addSymbol(atom(id), Var, typeOf(type),
+		  StructLayout::sizeOf(typeOf(type)));
+
+		if (!result) {
+			reportError(id, "Multiply declared identifier", std::string(atomText(atom(id))));
+		}
+
+		if (tag(type) == Tag::Void) {
+			reportError(id, "Non-function declared void", std::string(atomText(atom(id))));
+			result = false;
+		}
+
+		return result;
+	}
+
+	Atom structName = atom(first(type));
+	SymbolTableEntry* entry;
+	if (symTab->getGlobalScope() == nullptr) {
+		entry = symTab->findEntry(structName);
+	} else {
+		entry = symTab->getGlobalScope()->findEntry(structName);
+	}
+
+	if (entry->getKind() != Struct) {
+		reportError(n, "Invalid name of struct type", std::string(atomText(atom(id))));
+		return false;
+	}
+	return symTab->addSymbol(atom(id), Struct, typeOf(type),
+	  StructLayout::sizeOf(entry));
+}
+
+bool FlatAST::analyzeStructDecl(Node n, SymbolTable * symTab){
+	Atom name = atom(first(n));
+	bool result = symTab->addSymbol(name, Struct, TypeTable::global().structName(), -1);
+	SymbolTableEntry* entry = symTab->findEntry(name);
+	SymbolTable* structTable = symTab->getStructScope(entry);
+	structTable->setGlobalScope(symTab);
+	if (!result) {
+		return false;
+	}
+	result = analyze(second(n), structTable);
+	symTab->setLayout(entry);
+	return result;
+}
+
+bool FlatAST::analyzeDotAccess(Node n, SymbolTable * symTab){
+	Node exp = first(n);
+	Node id = second(n);
+	bool result = analyze(exp, symTab);
+	SymbolTableEntry *& structEntry = myEntries[n];
+	structEntry = myEntries[exp];
+	if (structEntry->getKind() == NotFound) {
+		return false;
+	}
+	if (structEntry->getKind() != Struct) {
+		reportError(n, "Dot-access of non-struct type",
+		  std::string(atomText(structEntry->getId())));
+		result = false;
+	}
+	if (structEntry->getType() != TypeTable::global().structName()) {
+		structEntry = symTab->findStruct(structEntry->getType());
+	}
+
+	SymbolTableEntry* entry = structEntry->findField(atom(id));
+	if (entry->getKind() == NotFound) {
+		reportError(id, "Invalid struct field name", std::string(atomText(atom(id))));
+		result = false;
+	} else {
+		myEntries[id] = entry;
+	}
+	structEntry = symTab->findStruct(entry->getType());
+
+	return result;
+}
+
+bool FlatAST::analyze(Node n, SymbolTable * symTab){
+	switch (tag(n)) {
+	case Tag::DeclList:
+	case Tag::FormalsList:
+	case Tag::StmtList:
+	case Tag::ExpList:
+		return analyzeList(n, symTab);
+
+	case Tag::VarDecl:
+		return analyzeVarDecl(n, symTab);
+	case Tag::FnDecl: {
+		const Type * type = TypeTable::global().function(formalTypes(child(n, 2)), typeOf(child(n, 0)));
+		bool result = symTab->addSymbol(atom(child(n, 1)), Func, type, -1);
+		symTab->addScope();
+		result = result && analyze(child(n, 2), symTab);
+		result = result && analyze(child(n, 3), symTab);
+		symTab->dropScope();
+		return result;
+	}
+	case Tag::FormalDecl:
+		return symTab->addSymbol(atom(second(n)), Var, typeOf(first(n)),
+		  StructLayout::sizeOf(typeOf(first(n))));
+	case Tag::StructDecl:
+		return analyzeStructDecl(n, symTab);
+	case Tag::FnBody:
+		analyze(first(n), symTab);
+		return analyze(second(n), symTab);
+
+	case Tag::Id: {
+		SymbolTableEntry * entry = symTab->findEntry(atom(n));
+		myEntries[n] = entry;
+		if (entry->getKind() == NotFound) {
+			reportError(n, "Undeclared identifier", std::string(atomText(atom(n))));
+			return false;
+		}
+		return true;
+	}
+	case Tag::DotAccess:
+		return analyzeDotAccess(n, symTab);
+	case Tag::Assign:
+		analyze(first(n), symTab);
+		analyze(second(n), symTab);
+		return true;
+	case Tag::AssignStmt:
+		analyze(first(n), symTab);
+		return true;
+
+	case Tag::CallExp:
+	case Tag::Plus:
+	case Tag::Minus:
+	case Tag::Times:
+	case Tag::Divide:
+	case Tag::And:
+	case Tag::Or:
+	case Tag::Equals:
+	case Tag::NotEquals:
+	case Tag::Less:
+	case Tag::Greater:
+	case Tag::LessEq:
+	case Tag::GreaterEq: {
+		bool result = analyze(first(n), symTab);
+		return result && analyze(second(n), symTab);
+	}
+
+	case Tag::UnaryMinus:
+	case Tag::Not:
+	case Tag::PostIncStmt:
+	case Tag::PostDecStmt:
+	case Tag::ReadStmt:
+	case Tag::WriteStmt:
+	case Tag::CallStmt:
+		return analyze(first(n), symTab);
+	case Tag::ReturnStmt:
+		return first(n) == NoNode || analyze(first(n), symTab);
+
+	case Tag::IfStmt:
+	case Tag::WhileStmt: {
+		bool result = analyze(child(n, 0), symTab);
+		symTab->addScope();
+		result = result && analyze(child(n, 1), symTab);
+		result = result && analyze(child(n, 2), symTab);
+		symTab->dropScope();
+		return result;
+	}
+	case Tag::IfElseStmt: {
+		bool result = analyze(child(n, 0), symTab);
+		symTab->addScope();
+		result = result && analyze(child(n, 1), symTab);
+		result = result && analyze(child(n, 2), symTab);
+		symTab->dropScope();
+		symTab->addScope();
+		result = analyze(child(n, 0), symTab);
+		result = result && analyze(child(n, 3), symTab);
+		result = result && analyze(child(n, 4), symTab);
+		symTab->dropScope();
+		return result;
+	}
+
+	default:
+		//types and literals
+		return true;
+	}
+}
+
+}
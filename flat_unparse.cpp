@@ -0,0 +1,255 @@
+#include "flat_ast.hpp"
+
+namespace LILC{
+
+//Prints what the ASTNode of each tag prints in unparse.cpp
+
+static void doIndent(std::ostream& out, int indent){
+	for (int k = 0 ; k < indent; k++){ out << " "; }
+}
+
+static const char * binaryOperator(FlatAST::Tag tag){
+	switch (tag) {
+	case FlatAST::Tag::Plus: return " + ";
+	case FlatAST::Tag::Minus: return " - ";
+	case FlatAST::Tag::Times: return " * ";
+	case FlatAST::Tag::Divide: return " / ";
+	case FlatAST::Tag::And: return " && ";
+	case FlatAST::Tag::Or: return " || ";
+	case FlatAST::Tag::Equals: return " == ";
+	case FlatAST::Tag::NotEquals: return " != ";
+	case FlatAST::Tag::Less: return " < ";
+	case FlatAST::Tag::Greater: return " > ";
+	case FlatAST::Tag::LessEq: return " <= ";
+	default: return " >= ";
+	}
+}
+
+void FlatAST::unparse(std::ostream& out, int indent){
+	unparse(out, myRoot, indent);
+}
+
+void FlatAST::unparseList(std::ostream& out, Node n, int indent, const char * separator){
+	for (const Node * it = begin(n); it != end(n); ++it) {
+		unparse(out, *it, indent);
+		if (separator != nullptr && it + 1 != end(n)) {
+			out << separator;
+		}
+	}
+}
+
+void FlatAST::unparse(std::ostream& out, Node n, int indent){
+	switch (tag(n)) {
+	case Tag::Program:
+		unparse(out, first(n), indent);
+		break;
+	case Tag::DeclList:
+	case Tag::StmtList:
+		unparseList(out, n, indent, nullptr);
+		break;
+	case Tag::FormalsList:
+	case Tag::ExpList:
+		unparseList(out, n, indent, ", ");
+		break;
+
+	case Tag::VarDecl:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << " ";
+		unparse(out, second(n), 0);
+		out << ";\n";
+		break;
+	case Tag::FnDecl:
+		doIndent(out, indent);
+		unparse(out, child(n, 0), 0);
+		out << " ";
+		unparse(out, child(n, 1), 0);
+		out << "(";
+		unparse(out, child(n, 2), 0);
+		out << ")";
+		unparse(out, child(n, 3), 0);
+		break;
+	case Tag::FormalDecl:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << " ";
+		unparse(out, second(n), 0);
+		break;
+	case Tag::StructDecl:
+		doIndent(out, indent);
+		out << "struct ";
+		unparse(out, first(n), 0);
+		out << "\n{\n";
+		unparse(out, second(n), indent+4);
+		out << "};\n";
+		break;
+	case Tag::FnBody:
+		doIndent(out, indent);
+		out << "\n{\n";
+		unparse(out, first(n), indent+4);
+		unparse(out, second(n), indent+4);
+		out << "}\n";
+		break;
+
+	case Tag::Int:
+		out << "int";
+		break;
+	case Tag::Bool:
+		out << "bool";
+		break;
+	case Tag::Void:
+		out << "void";
+		break;
+	case Tag::Struct:
+		doIndent(out, indent);
+		out << "struct ";
+		unparse(out, first(n), 0);
+		break;
+
+	case Tag::Id:
+		out << atomText(atom(n));
+		if (n < myEntries.size() && myEntries[n] != nullptr) {
+			out << "(" << myEntries[n]->getType()->spelling() << ")";
+		}
+		break;
+	case Tag::IntLit:
+		doIndent(out, indent);
+		out << value(n);
+		break;
+	case Tag::StrLit:
+		doIndent(out, indent);
+		out << string(n);
+		break;
+	case Tag::True:
+		doIndent(out, indent);
+		out << "true";
+		break;
+	case Tag::False:
+		doIndent(out, indent);
+		out << "false";
+		break;
+	case Tag::DotAccess:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << ".";
+		unparse(out, second(n), 0);
+		break;
+	case Tag::Assign:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << " = ";
+		unparse(out, second(n), 0);
+		break;
+	case Tag::CallExp:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << "(";
+		unparse(out, second(n), 0);
+		out << ")";
+		break;
+	case Tag::UnaryMinus:
+	case Tag::Not:
+		doIndent(out, indent);
+		out << "(";
+		out << (tag(n) == Tag::Not ? "!" : "-");
+		unparse(out, first(n), 0);
+		out << ")";
+		break;
+	case Tag::Times:
+		//TimesNode leaves out the parentheses
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << " * ";
+		unparse(out, second(n), 0);
+		break;
+	case Tag::Plus:
+	case Tag::Minus:
+	case Tag::Divide:
+	case Tag::And:
+	case Tag::Or:
+	case Tag::Equals:
+	case Tag::NotEquals:
+	case Tag::Less:
+	case Tag::Greater:
+	case Tag::LessEq:
+	case Tag::GreaterEq:
+		doIndent(out, indent);
+		//and LessEqNode opens them twice
+		out << (tag(n) == Tag::LessEq ? "()" : "(");
+		unparse(out, first(n), 0);
+		out << binaryOperator(tag(n));
+		unparse(out, second(n), 0);
+		out << ")";
+		break;
+
+	case Tag::AssignStmt:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << ";\n";
+		break;
+	case Tag::PostIncStmt:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << "++;\n";
+		break;
+	case Tag::PostDecStmt:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << "--;\n";
+		break;
+	case Tag::ReadStmt:
+		doIndent(out, indent);
+		out << "cin >> ";
+		unparse(out, first(n), 0);
+		out << ";\n";
+		break;
+	case Tag::WriteStmt:
+		doIndent(out, indent);
+		out << "cout << ";
+		unparse(out, first(n), 0);
+		out << ";\n";
+		break;
+	case Tag::IfStmt:
+	case Tag::WhileStmt:
+		doIndent(out, indent);
+		out << (tag(n) == Tag::IfStmt ? "if(" : "while(");
+		unparse(out, child(n, 0), 0);
+		out << ") {\n";
+		unparse(out, child(n, 1), indent+4);
+		unparse(out, child(n, 2), indent+4);
+		doIndent(out, indent);
+		out << "}\n";
+		break;
+	case Tag::IfElseStmt:
+		doIndent(out, indent);
+		out << "if(";
+		unparse(out, child(n, 0), 0);
+		out << ") {\n";
+		unparse(out, child(n, 1), indent+4);
+		unparse(out, child(n, 2), indent+4);
+		doIndent(out, indent);
+		out << "}\n";
+		doIndent(out, indent);
+		out << "else {\n";
+		unparse(out, child(n, 3), indent+4);
+		unparse(out, child(n, 4), indent+4);
+		doIndent(out, indent);
+		out << "}\n";
+		break;
+	case Tag::CallStmt:
+		doIndent(out, indent);
+		unparse(out, first(n), 0);
+		out << ";\n";
+		break;
+	case Tag::ReturnStmt:
+		doIndent(out, indent);
+		out << "return ";
+		if (first(n) != NoNode) {
+			unparse(out, first(n), 0);
+		}
+		out << ";\n";
+		break;
+	}
+}
+
+}
@@ -0,0 +1,258 @@
+// Writes a large, valid LIL'C program for benchmarking the front end.
+// Its shape is set on the command line; see usage().
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+struct Shape{
+	int structs = 50;    // plain structs
+	int fields = 8;      // fields per struct
+	int chain = 6;       // depth of the nested struct chain
+	int functions = 500;
+	int stmts = 40;      // statements per function body
+	int nesting = 4;     // deepest if/while nesting
+	int exprLength = 8;  // operands per expression chain
+	unsigned seed = 1;
+};
+
+class Generator{
+public:
+	Generator(const Shape& shape, FILE * out)
+	: myShape(shape), myOut(out), myRandom(shape.seed) { }
+
+	void program(){
+		for (int s = 0; s < myShape.structs; s++) {
+			structDecl(s);
+		}
+		chainDecls();
+		std::fprintf(myOut, "int g;\nbool flag;\nstruct Chain%d root;\n\n",
+		  myShape.chain - 1);
+		for (int f = 0; f < myShape.functions; f++) {
+			function(f);
+		}
+	}
+
+private:
+	int pick(int n) { return (int)(myRandom() % (unsigned)n); }
+
+	void indent(int depth){
+		for (int i = 0; i < depth; i++) {
+			std::fputc('\t', myOut);
+		}
+	}
+
+	void structDecl(int s){
+		std::fprintf(myOut, "struct S%d {\n", s);
+		for (int f = 0; f < myShape.fields; f++) {
+			std::fprintf(myOut, "\t%s f%d;\n", f % 3 == 2 ? "bool" : "int", f);
+		}
+		std::fprintf(myOut, "};\n\n");
+	}
+
+	// Chain0 has plain fields; each ChainK nests a ChainK-1 as "next",
+	// so root.next.next...v is a dot-access chain as deep as the shape
+	void chainDecls(){
+		for (int c = 0; c < myShape.chain; c++) {
+			std::fprintf(myOut, "struct Chain%d {\n", c);
+			if (c > 0) {
+				std::fprintf(myOut, "\tstruct Chain%d next;\n", c - 1);
+			}
+			std::fprintf(myOut, "\tint v;\n\tbool b;\n};\n\n");
+		}
+	}
+
+	std::string chainLoc(){
+		std::string loc = "root";
+		int depth = pick(myShape.chain);
+		for (int i = 0; i < depth; i++) {
+			loc += ".next";
+		}
+		return loc + ".v";
+	}
+
+	std::string intTerm(){
+		switch (pick(6)) {
+		case 0: return std::to_string(pick(10000));
+		case 1: return "a";
+		case 2: return "x";
+		case 3: return "y";
+		case 4: return "s.f" + std::to_string(3 * pick((myShape.fields + 2) / 3));
+		default: return chainLoc();
+		}
+	}
+
+	std::string intExp(int length){
+		static const char * const OPS[] = { " + ", " - ", " * ", " / " };
+		std::string exp = intTerm();
+		for (int i = 1; i < length; i++) {
+			if (pick(5) == 0) {
+				exp = "(" + exp + ")";
+			}
+			exp += OPS[pick(4)];
+			exp += pick(8) == 0 ? "-" + intTerm() : intTerm();
+		}
+		return exp;
+	}
+
+	std::string boolExp(int length){
+		static const char * const CMPS[] = { " < ", " > ", " <= ", " >= ", " == ", " != " };
+		std::string exp;
+		for (int i = 0; i < length; i += 2) {
+			if (i > 0) {
+				exp += pick(2) ? " && " : " || ";
+			}
+			switch (pick(4)) {
+			case 0: exp += pick(2) ? "!c" : "flag"; break;
+			case 1: exp += pick(2) ? "true" : "false"; break;
+			default: exp += intTerm() + CMPS[pick(6)] + intTerm(); break;
+			}
+		}
+		return exp;
+	}
+
+	// a call to a function declared before this one
+	std::string call(int self){
+		std::string f = "f" + std::to_string(pick(self));
+		return f + "(" + intExp(2) + ", " + boolExp(2) + ")";
+	}
+
+	void locals(int depth, int level){
+		indent(depth);
+		std::fprintf(myOut, "int x%d;\n", level);
+		indent(depth);
+		std::fprintf(myOut, "bool c%d;\n", level);
+	}
+
+	void statement(int self, int depth, int level){
+		int kind = pick(12);
+		if (level < myShape.nesting && kind < 2) {
+			indent(depth);
+			std::fprintf(myOut, "%s (%s) {\n", kind == 0 ? "if" : "while",
+			  boolExp(myShape.exprLength / 2).c_str());
+			block(self, depth + 1, level + 1);
+			if (kind == 0 && pick(2)) {
+				indent(depth);
+				std::fprintf(myOut, "} else {\n");
+				block(self, depth + 1, level + 1);
+			}
+			indent(depth);
+			std::fprintf(myOut, "}\n");
+			return;
+		}
+		indent(depth);
+		switch (kind) {
+		case 2:
+			std::fprintf(myOut, "c = %s;\n", boolExp(myShape.exprLength).c_str());
+			break;
+		case 3:
+			std::fprintf(myOut, "%s = %s;\n", chainLoc().c_str(),
+			  intExp(myShape.exprLength).c_str());
+			break;
+		case 4:
+			std::fprintf(myOut, "%s++;\n", pick(2) ? "x" : "y");
+			break;
+		case 5:
+			std::fprintf(myOut, "input >> s.f%d;\n", 3 * pick((myShape.fields + 2) / 3));
+			break;
+		case 6:
+			if (pick(2)) {
+				std::fprintf(myOut, "output << \"f%d: \\t%d\\n\";\n", self, pick(100));
+			} else {
+				std::fprintf(myOut, "output << %s;\n", intExp(3).c_str());
+			}
+			break;
+		case 7:
+			if (self > 0) {
+				std::fprintf(myOut, "y = %s;\n", call(self).c_str());
+				break;
+			}
+			// fall through
+		default:
+			std::fprintf(myOut, "x = %s;\n", intExp(myShape.exprLength).c_str());
+			break;
+		}
+	}
+
+	// the body of an if or while, with its own locals
+	void block(int self, int depth, int level){
+		locals(depth, level);
+		int count = 1 + pick(4);
+		for (int i = 0; i < count; i++) {
+			statement(self, depth, level);
+		}
+	}
+
+	void function(int f){
+		std::fprintf(myOut, "int f%d(int a, bool b) {\n", f);
+		std::fprintf(myOut, "\tint x;\n\tint y;\n\tbool c;\n\tstruct S%d s;\n",
+		  pick(myShape.structs));
+		for (int i = 0; i < myShape.stmts; i++) {
+			statement(f, 1, 0);
+		}
+		std::fprintf(myOut, "\treturn x;\n}\n\n");
+	}
+
+	const Shape& myShape;
+	FILE * myOut;
+	std::mt19937 myRandom;
+};
+
+static int usage(){
+	std::fprintf(stderr,
+	  "Usage: gen_corpus [options] [outfile]\n"
+	  "  --structs=N    struct declarations (50)\n"
+	  "  --fields=N     fields per struct (8)\n"
+	  "  --chain=N      depth of nested struct field chains (6)\n"
+	  "  --functions=N  function declarations (500)\n"
+	  "  --stmts=N      statements per function (40)\n"
+	  "  --nesting=N    deepest if/while nesting (4)\n"
+	  "  --exprlen=N    operands per expression chain (8)\n"
+	  "  --seed=N       random seed (1)\n");
+	return 1;
+}
+
+// sets *value if arg is --name=N
+static bool option(const char * arg, const char * name, int * value){
+	size_t length = std::strlen(name);
+	if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') {
+		return false;
+	}
+	*value = std::atoi(arg + length + 1);
+	return true;
+}
+
+int main(int argc, char ** argv){
+	Shape shape;
+	int seed = shape.seed;
+	int arg = 1;
+	for (; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; arg++) {
+		if (!option(argv[arg], "--structs", &shape.structs)
+		  && !option(argv[arg], "--fields", &shape.fields)
+		  && !option(argv[arg], "--chain", &shape.chain)
+		  && !option(argv[arg], "--functions", &shape.functions)
+		  && !option(argv[arg], "--stmts", &shape.stmts)
+		  && !option(argv[arg], "--nesting", &shape.nesting)
+		  && !option(argv[arg], "--exprlen", &shape.exprLength)
+		  && !option(argv[arg], "--seed", &seed)) {
+			return usage();
+		}
+	}
+	shape.seed = seed;
+	if (argc - arg > 1 || shape.structs < 1 || shape.fields < 1
+	  || shape.chain < 1 || shape.exprLength < 1) {
+		return usage();
+	}
+
+	FILE * out = stdout;
+	if (arg < argc) {
+		out = std::fopen(argv[arg], "w");
+		if (out == nullptr) {
+			std::perror(argv[arg]);
+			return 1;
+		}
+	}
+	Generator(shape, out).program();
+	return std::fclose(out) == 0 ? 0 : 1;
+}
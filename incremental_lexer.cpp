@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "incremental_lexer.hpp"
+#include "fast_scanner.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+//index of the first token at or past offset
+static size_t firstAt(const TokenBuffer& tokens, size_t offset){
+	const TokenRec * found = std::lower_bound(tokens.begin(), tokens.end(),
+	  offset, [](const TokenRec& tok, size_t at){ return tok.offset < at; });
+	return found - tokens.begin();
+}
+
+void relex(TokenBuffer * tokens, const char * text, size_t size,
+  const TextEdit& edit){
+	size_t oldSize = size - edit.inserted + edit.removed;
+	const TokenRec& oldEnd = (*tokens)[tokens->size() - 1];
+	bool oldStopped = oldEnd.offset < oldSize;
+
+	//Start of the line the edit starts on; the text before the edit
+	// is the same in both inputs
+	size_t begin = edit.offset;
+	while (begin > 0 && text[begin - 1] != '\n') {
+		begin--;
+	}
+	if (oldStopped && oldEnd.offset < begin) {
+		//the edit is past the point the scan gave up at
+		return;
+	}
+	//Just past the end of the line the edit ends on, in the new
+	// input and in the old one
+	size_t end = size;
+	size_t editEnd = edit.offset + edit.inserted;
+	const void * newline = memchr(text + editEnd, '\n', size - editEnd);
+	if (newline != nullptr) {
+		end = static_cast<const char *>(newline) - text + 1;
+	}
+	if (oldStopped && oldEnd.offset < end - edit.inserted + edit.removed) {
+		end = size;
+	}
+	size_t oldEndOffset = end - edit.inserted + edit.removed;
+
+	TokenBuffer fresh;
+	std::vector<Diagnostic> diagnostics;
+	LilC_FastScanner scanner(text + begin, end - begin);
+	scanner.holdDiagnostics(&diagnostics);
+	scanner.tokenize(&fresh);
+
+	if (!diagnostics.empty()) {
+		//only now is it worth counting the lines before begin
+		size_t linesBefore = std::count(text, text + begin, '\n');
+		for (Diagnostic& diag : diagnostics) {
+			//the integer-overflow warning is always reported at 0:0
+			if (diag.line != 0) {
+				diag.line += linesBefore;
+			}
+			Lexer::print(diag);
+		}
+	}
+
+	//Rebase the new tokens, copying their strings into tokens
+	size_t count = fresh.size() - 1;
+	std::vector<TokenRec> recs;
+	recs.reserve(count + 1);
+	for (size_t i = 0; i < count; i++) {
+		TokenRec tok = fresh[i];
+		tok.offset += begin;
+		if (tok.tag == TokenTag::STRINGLITERAL) {
+			tok.payload = tokens->addString(fresh.stringAt(tok.payload));
+		}
+		recs.push_back(tok);
+	}
+
+	size_t first = firstAt(*tokens, begin);
+	size_t stop = fresh[count].offset;
+	if (stop < end - begin || end == size) {
+		//this scan ends the input, one way or the other
+		recs.push_back(TokenRec{TokenTag::END, (uint32_t)(begin + stop), 0});
+		tokens->splice(first, tokens->size(), recs.data(), recs.size(), 0);
+		return;
+	}
+	size_t last = firstAt(*tokens, oldEndOffset);
+	tokens->splice(first, last, recs.data(), recs.size(),
+	  (int64_t)edit.inserted - (int64_t)edit.removed);
+}
+
+}
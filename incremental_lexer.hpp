@@ -0,0 +1,31 @@
+#ifndef LILC_INCREMENTAL_LEXER_HPP
+#define LILC_INCREMENTAL_LEXER_HPP
+
+#include <cstddef>
+
+#include "token_buffer.hpp"
+
+namespace LILC{
+
+//removed bytes at offset were replaced by inserted new ones
+struct TextEdit{
+	size_t offset;
+	size_t removed;
+	size_t inserted;
+};
+
+//Brings tokens, scanned from the input before edit, up to date with
+// text, the input after it. No LIL'C token spans a newline, so only
+// the lines the edit touched are scanned again; the new tokens are
+// spliced in and the ones after them moved by the change in length.
+// Diagnostics are reported for the rescanned lines only.
+//
+// The old text is gone by then, so tokens must have been scanned with
+// setCopyStrings(true). A rejected string literal ends a scan early;
+// if the edit touches the line where the old scan stopped, everything
+// from the edit on is scanned again.
+void relex(TokenBuffer * tokens, const char * text, size_t size,
+  const TextEdit& edit);
+
+}
+#endif
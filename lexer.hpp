@@ -0,0 +1,81 @@
+#ifndef LILC_LEXER_HPP
+#define LILC_LEXER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "grammar.hh"
+#include "token_buffer.hpp"
+#include "tokens.hpp"
+
+namespace LILC{
+
+//A warning or error the scanner has held back instead of printing
+struct Diagnostic{
+	size_t line;
+	size_t column;
+	bool isError;
+	std::string msg;
+};
+
+//What the compiler needs from a scanner. LilC_Scanner (flex) and
+// LilC_FastScanner (hand-written) both implement it, and for the same
+// input they must produce the same tokens and the same diagnostics.
+class Lexer{
+public:
+	virtual ~Lexer() { }
+
+	// Returns the next token's tag; *token is set to a heap-allocated
+	// Token for it
+	virtual int yylex(Token ** const token) = 0;
+	// Scans the whole input into out, ending with an END token
+	virtual void tokenize(TokenBuffer * out) = 0;
+	// Scans on from where the last call stopped, appending to out, up
+	// to the first token that ends at least bytes further into the
+	// input. Returns false once it has scanned the rest of the input,
+	// ending with an END token.
+	virtual bool tokenize(TokenBuffer * out, size_t bytes) = 0;
+
+	void warn(int lineNum, int charNum, std::string msg){
+		report(Diagnostic{(size_t)lineNum, (size_t)charNum, false, msg});
+	}
+
+	void error(int lineNum, int charNum, std::string msg){
+		report(Diagnostic{(size_t)lineNum, (size_t)charNum, true, msg});
+	}
+
+	// Collect diagnostics into held rather than printing them
+	void holdDiagnostics(std::vector<Diagnostic> * held){
+		this->held = held;
+	}
+	static void print(const Diagnostic& diag){
+		std::cerr << diag.line << ":" << diag.column
+		  << (diag.isError ? " ***ERROR*** " : " ***WARNING*** ")
+		  << diag.msg << std::endl;
+	}
+
+	size_t line() const { return lineNum; }
+
+protected:
+	// back to the start of a new input
+	void restart(){
+		lineNum = 1;
+		charNum = 1;
+	}
+
+	void report(Diagnostic diag){
+		if (held != nullptr) {
+			held->push_back(std::move(diag));
+		} else {
+			print(diag);
+		}
+	}
+
+	size_t lineNum = 1;
+	size_t charNum = 1;
+	std::vector<Diagnostic> * held = nullptr;
+};
+
+}
+#endif
@@ -6,14 +6,18 @@
 %define parser_class_name {LilC_Parser}
 %output "lilc_parser.cc"
 %token-table
+%locations
+%define api.location.type {uint32_t}
 
 %code requires{
-   #include <list>
+   #include <cstdint>
    #include "tokens.hpp"
+   #include "token_buffer.hpp"
    #include "ast.hpp"
+   #include "ast_builder.hpp"
    namespace LILC {
       class LilC_Compiler;
-      class LilC_Scanner;
+      class TokenCursor;
    }
 
 // The following definitions is missing when %locations isn't used
@@ -27,8 +31,9 @@
 
 }
 
-%parse-param { LilC_Scanner  &scanner  }
+%parse-param { TokenCursor   &cursor   }
 %parse-param { LilC_Compiler &compiler }
+%parse-param { ASTBuilder    &build    }
 
 %code{
    #include <iostream>
@@ -37,38 +42,43 @@
 
    /* include for interoperation between scanner/parser */
    #include "lilc_compiler.hpp"
+   #include "token_cursor.hpp"
 
 #undef yylex
-#define yylex scanner.yylex
+#define yylex cursor.yylex
+
+/* A location is just the byte offset of the first token of a rule */
+#define YYLLOC_DEFAULT(Current, Rhs, N) \
+   (Current) = YYRHSLOC( Rhs, (N) ? 1 : 0 )
+
+/* Nodes are built through build, which may be making a FlatAST
+ * instead; see ast_builder.hpp for what that asks of the actions. */
 }
 
-/*%define api.value.type variant*/
+/* Every value is a pointer: nodes and lists (see ASTBuilder::handle)
+ * are in the AST arena and go with it, so nothing on the stack needs
+ * destroying when a parse fails. A variant stack of lists held by
+ * value costs half again the parse time in the switches it generates
+ * to move them. */
 %union {
-
-LILC::IntLitToken * intTokenValue;
-LILC::StringLitToken * strTokenValue;
-LILC::IDToken * idTokenValue;
-LILC::Token * tokenValue;
-LILC::ASTNode * astNode;
+const LILC::TokenRec * tokenRec;
 LILC::ProgramNode * programNode;
-std::list<DeclNode *> * declList;
-std::list<FormalDeclNode * > * formalsList;
+LILC::DeclList * declList;
+LILC::FormalsList * formalsList;
+LILC::StmtList * stmtList;
+LILC::ExpList * expList;
 LILC::DeclNode * declNode;
 LILC::FnDeclNode * fnDecl;
 LILC::FormalDeclNode * formalDecl;
 LILC::StructDeclNode * structDeclNode;
 LILC::FormalsListNode * formals;
 LILC::FnBodyNode * fnBody;
-std::list<StmtNode *> * stmtList;
-std::list<ExpNode *> * expList;
 LILC::TypeNode * typeNode;
 LILC::StmtNode * stmtNode;
 LILC::ExpNode * exp;
 LILC::IdNode * idNode;
 LILC::AssignNode * assignNode;
 LILC::CallExpNode * callNode;
-
-	/*LILC::Token * token;*/
 }
 
 %define parse.assert
@@ -88,9 +98,9 @@ LILC::CallExpNode * callNode;
 %token               ELSE
 %token               WHILE
 %token               RETURN
-%token <idTokenValue> ID
-%token <intTokenValue>      INTLITERAL
-%token <strTokenValue>      STRINGLITERAL
+%token <tokenRec> ID
+%token <tokenRec> INTLITERAL
+%token <tokenRec> STRINGLITERAL
 %token               LCURLY
 %token               RCURLY
 %token               LPAREN
@@ -127,6 +137,7 @@ LILC::CallExpNode * callNode;
 %type <declNode> decl
 %type <declNode> varDecl
 %type <typeNode> type
+%type <typeNode> structType
 %type <idNode> id
 %type <declList> structBody
 %type <structDeclNode> structDecl
@@ -156,22 +167,26 @@ LILC::CallExpNode * callNode;
 %left PLUS MINUS
 %left TIMES DIVIDE
 %left NOT
+
+/* DescentParser (descent_parser.cpp) parses this same grammar by hand,
+ * and is what P4 uses when given --descent; a change to a rule or a
+ * precedence here needs the matching change there.
+ */
 %%
 
 program : declList 
           {
-          $$ = new ProgramNode(new DeclListNode($1));
+          $$ = build.make<ProgramNode>(@$, build.make<DeclListNode>(@1, *$1));
           compiler.setASTRoot($$);
           }
 
 declList : declList decl 
            {
-           $1->push_back($2);
-           $$ = $1;
+           $$ = compiler.topLevelDecl(build, $1, $2);
            }
          | /* epsilon */ 
            {
-           $$ = new std::list<DeclNode *>();
+           $$ = build.handle(build.list<DeclList>(@$));
            }
 
 decl : varDecl { $$ = $1; }
@@ -181,174 +196,169 @@ decl : varDecl { $$ = $1; }
 
 varDecl : type id SEMICOLON 
           {
-          $$ = new VarDeclNode($1, $2, VarDeclNode::NOT_STRUCT);
+          $$ = build.make<VarDeclNode>(@$, $1, $2, VarDeclNode::NOT_STRUCT);
           }
-        | STRUCT id id SEMICOLON 
+        | structType id SEMICOLON 
           {
-          $$ = new VarDeclNode(new StructNode($2), $3, 0);
+          $$ = build.make<VarDeclNode>(@$, $1, $2, 0);
           }
 
+/* A rule of its own so that the StructNode is built before the id after it */
+structType : STRUCT id
+             {
+             $$ = build.make<StructNode>(@2, $2);
+             }
+
 varDeclList : /* epsilon */ 
               {
-              $$ = new std::list<DeclNode *>();
+              $$ = build.handle(build.list<DeclList>(@$));
               }
             | varDeclList varDecl 
               {
-              $1->push_back($2);
-              $$ = $1;
+              $$ = build.append($1, $2);
               }
 
 fnDecl : type id formals fnBody 
          {
-         $$ = new FnDeclNode($1, $2, $3, $4);
+         $$ = build.make<FnDeclNode>(@$, $1, $2, $3, $4);
          }
 
 structDecl : STRUCT id LCURLY structBody RCURLY SEMICOLON 
              {
-             $$ = new StructDeclNode($2, new DeclListNode($4)) ;
+             $$ = build.make<StructDeclNode>(@$, $2, build.make<DeclListNode>(@4, *$4));
              }
 
 structBody : structBody varDecl 
              {
-             $1->push_back($2);
-             $$ = $1;
+             $$ = build.append($1, $2);
              }
 
 structBody : varDecl 
              {
-             std::list<DeclNode *> * list = new std::list<DeclNode *>;
-             list->push_back($1);
-             $$ = list;
+             $$ = build.handle(build.list<DeclList>(@$, $1));
              }
 
 formals : LPAREN RPAREN 
           {
-          $$ = new FormalsListNode(new std::list<FormalDeclNode *>()); 
+          $$ = build.make<FormalsListNode>(@$, build.list<FormalsList>(@$)); 
           }
 
 formals : LPAREN formalsList RPAREN 
           {
-          $$ = new FormalsListNode($2); 
+          $$ = build.make<FormalsListNode>(@$, *$2); 
           }
 
 formalsList : formalDecl 
               {
-              std::list<FormalDeclNode *> * list = new std::list<FormalDeclNode *>();
-              list->push_back($1);
-              $$ = list;
+              $$ = build.handle(build.list<FormalsList>(@$, $1));
               }
-            | formalDecl COMMA formalsList 
+            | formalsList COMMA formalDecl 
               {
-              $3->push_front($1);
-              $$ = $3;
+              $$ = build.append($1, $3);
               }
 
 fnBody : LCURLY varDeclList stmtList RCURLY {
-         $$ = new FnBodyNode(new DeclListNode($2), new StmtListNode($3));
+         $$ = build.make<FnBodyNode>(@$, build.make<DeclListNode>(@2, *$2), build.make<StmtListNode>(@3, *$3));
        }
 
 formalDecl : type id 
              {
-             $$ = new FormalDeclNode($1, $2);
+             $$ = build.make<FormalDeclNode>(@$, $1, $2);
              }
 
 stmtList : /* epsilon */ 
            { 
-           $$ = new std::list<StmtNode *>();}
+           $$ = build.handle(build.list<StmtList>(@$));}
          | stmtList stmt 
            { 
-           $1->push_back($2);
-           $$ = $1;
+           $$ = build.append($1, $2);
            }
 
-stmt : assignExp SEMICOLON { $$ = new AssignStmtNode($1); }
-     | loc PLUSPLUS SEMICOLON { $$ = new PostIncStmtNode($1); }
-     | loc MINUSMINUS SEMICOLON { $$ = new PostDecStmtNode($1); }
-     | INPUT READ loc SEMICOLON { $$ = new ReadStmtNode($3); }
-     | OUTPUT WRITE exp SEMICOLON { $$ = new WriteStmtNode($3); }
+stmt : assignExp SEMICOLON { $$ = build.make<AssignStmtNode>(@$, $1); }
+     | loc PLUSPLUS SEMICOLON { $$ = build.make<PostIncStmtNode>(@$, $1); }
+     | loc MINUSMINUS SEMICOLON { $$ = build.make<PostDecStmtNode>(@$, $1); }
+     | INPUT READ loc SEMICOLON { $$ = build.make<ReadStmtNode>(@$, $3); }
+     | OUTPUT WRITE exp SEMICOLON { $$ = build.make<WriteStmtNode>(@$, $3); }
      | IF LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY 
         { 
-        $$ = new IfStmtNode($3, new DeclListNode($6), new StmtListNode($7));
+        $$ = build.make<IfStmtNode>(@$, $3, build.make<DeclListNode>(@6, *$6), build.make<StmtListNode>(@7, *$7));
         }
      | IF LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY ELSE LCURLY varDeclList stmtList RCURLY
         { 
-        $$ = new IfElseStmtNode(
+        $$ = build.make<IfElseStmtNode>(@$,
                 $3, 
-                new DeclListNode($6), 
-                new StmtListNode($7), 
-                new DeclListNode($11), 
-                new StmtListNode($12)); 
+                build.make<DeclListNode>(@6, *$6), 
+                build.make<StmtListNode>(@7, *$7), 
+                build.make<DeclListNode>(@11, *$11), 
+                build.make<StmtListNode>(@12, *$12)); 
         }
      | WHILE LPAREN exp RPAREN LCURLY varDeclList stmtList RCURLY
         { 
-        $$ = new WhileStmtNode($3, new DeclListNode($6), new StmtListNode($7)); 
+        $$ = build.make<WhileStmtNode>(@$, $3, build.make<DeclListNode>(@6, *$6), build.make<StmtListNode>(@7, *$7)); 
         }
-     | RETURN exp SEMICOLON { $$ = new ReturnStmtNode($2); }
-     | RETURN SEMICOLON { $$ = new ReturnStmtNode(nullptr); }
-     | fncall SEMICOLON { $$ = new CallStmtNode($1); }
+     | RETURN exp SEMICOLON { $$ = build.make<ReturnStmtNode>(@$, $2); }
+     | RETURN SEMICOLON { $$ = build.make<ReturnStmtNode>(@$, nullptr); }
+     | fncall SEMICOLON { $$ = build.make<CallStmtNode>(@$, $1); }
 
 
-assignExp : loc ASSIGN exp { $$ = new AssignNode($1, $3); }
+assignExp : loc ASSIGN exp { $$ = build.make<AssignNode>(@$, $1, $3); }
 
 exp : assignExp { $$ = $1;}
-    | exp PLUS exp { $$ = new PlusNode($1, $3); }
-    | exp MINUS exp { $$ = new MinusNode($1, $3); }
-    | exp TIMES exp { $$ = new TimesNode($1, $3); }
-    | exp DIVIDE exp { $$ = new DivideNode($1, $3); }
-    | NOT exp { $$ = new NotNode($2); }
-    | exp AND exp { $$ = new AndNode($1, $3); }
-    | exp OR exp { $$ = new OrNode($1, $3); }
-    | exp EQUALS exp { $$ = new EqualsNode($1, $3); }
-    | exp NOTEQUALS exp { $$ = new NotEqualsNode($1, $3); }
-    | exp LESS exp { $$ = new LessNode($1, $3); }
-    | exp GREATER exp { $$ = new GreaterNode($1, $3); }
-    | exp LESSEQ exp { $$ = new LessEqNode($1, $3); }
-    | exp GREATEREQ exp { $$ = new GreaterEqNode($1, $3); }
-    | MINUS term { $$ = new UnaryMinusNode($2); }
+    | exp PLUS exp { $$ = build.make<PlusNode>(@$, $1, $3); }
+    | exp MINUS exp { $$ = build.make<MinusNode>(@$, $1, $3); }
+    | exp TIMES exp { $$ = build.make<TimesNode>(@$, $1, $3); }
+    | exp DIVIDE exp { $$ = build.make<DivideNode>(@$, $1, $3); }
+    | NOT exp { $$ = build.make<NotNode>(@$, $2); }
+    | exp AND exp { $$ = build.make<AndNode>(@$, $1, $3); }
+    | exp OR exp { $$ = build.make<OrNode>(@$, $1, $3); }
+    | exp EQUALS exp { $$ = build.make<EqualsNode>(@$, $1, $3); }
+    | exp NOTEQUALS exp { $$ = build.make<NotEqualsNode>(@$, $1, $3); }
+    | exp LESS exp { $$ = build.make<LessNode>(@$, $1, $3); }
+    | exp GREATER exp { $$ = build.make<GreaterNode>(@$, $1, $3); }
+    | exp LESSEQ exp { $$ = build.make<LessEqNode>(@$, $1, $3); }
+    | exp GREATEREQ exp { $$ = build.make<GreaterEqNode>(@$, $1, $3); }
+    | MINUS term { $$ = build.make<UnaryMinusNode>(@$, $2); }
     | term { $$ = $1; }
 
 term : loc { $$ = $1; }
-     | INTLITERAL { $$ = new IntLitNode($1); }
-     | STRINGLITERAL { $$ = new StrLitNode($1); }
-     | TRUE { $$ = new TrueNode(); }
-     | FALSE { $$ = new FalseNode(); }
+     | INTLITERAL { $$ = build.make<IntLitNode>(@$, $1->payload); }
+     | STRINGLITERAL { $$ = build.make<StrLitNode>(@$, build.copy(cursor.tokens().stringAt($1->payload))); }
+     | TRUE { $$ = build.make<TrueNode>(@$); }
+     | FALSE { $$ = build.make<FalseNode>(@$); }
      | LPAREN exp RPAREN { $$ = $2; }
      | fncall { $$ = $1; }
 
 fncall : id LPAREN RPAREN 
         { 
-        $$ = new CallExpNode($1, new ExpListNode(new std::list<ExpNode *>()));
+        $$ = build.make<CallExpNode>(@$, $1, build.make<ExpListNode>(@$, build.list<ExpList>(@$)));
         }
         | id LPAREN actualList RPAREN 
         { 
-        $$ = new CallExpNode($1, new ExpListNode($3)); 
+        $$ = build.make<CallExpNode>(@$, $1, build.make<ExpListNode>(@3, *$3)); 
         }
 
 actualList : exp 
         { 
-        std::list<ExpNode *> * list = new std::list<ExpNode *>();
-        list->push_back($1);
-        $$ = list;
+        $$ = build.handle(build.list<ExpList>(@$, $1));
         }
         | actualList COMMA exp 
         {
-        $1->push_back($3);
-        $$ = $1;
+        $$ = build.append($1, $3);
         }
 
-type : INT { $$ = new IntNode(); }
-     | BOOL { $$ = new BoolNode(); }
-     | VOID { $$ = new VoidNode(); }
+type : INT { $$ = build.make<IntNode>(@$); }
+     | BOOL { $$ = build.make<BoolNode>(@$); }
+     | VOID { $$ = build.make<VoidNode>(@$); }
 
 
 loc : id { $$ = $1; }
-    | loc DOT id { $$ = new DotAccessNode($1, $3); }
+    | loc DOT id { $$ = build.make<DotAccessNode>(@$, $1, $3); }
 
-id : ID { $$ = new IdNode($1); }
+id : ID { $$ = build.make<IdNode>(@$, $1->payload); }
 
 %%
 void
-LILC::LilC_Parser::error(const std::string &err_message )
+LILC::LilC_Parser::error(const location_type &loc, const std::string &err_message )
 {
-   std::cerr << "Error: " << err_message << "\n";
+   compiler.syntaxError( loc, err_message.c_str() );
 }
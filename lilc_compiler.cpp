@@ -1,214 +1,652 @@
+#include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <cassert>
 
 #include "lilc_compiler.hpp"
+#include "lilc_scanner.hpp"
+#include "fast_scanner.hpp"
+#include "parallel_lexer.hpp"
+#include "token_file.hpp"
 
 using TokenTag = LILC::LilC_Parser::token;
-using Lexeme = LILC::LilC_Parser::semantic_type;
 
 LILC::LilC_Compiler::~LilC_Compiler()
 {
-   delete(scanner);
-   scanner = nullptr;
+   delete(flexLexer);
+   flexLexer = nullptr;
    delete(parser);
    parser = nullptr;
-   delete(astRoot);
    astRoot = nullptr;
+   delete(pool);
+   pool = nullptr;
+   delete(symbolTable);
+   symbolTable = nullptr;
+}
+
+/* How much of the input a streaming parse has scanned ahead of it */
+static const size_t STREAM_WINDOW = 256 * 1024;
+
+static bool
+inputTooLarge( const char * const filename )
+{
+   std::cerr << filename << ": input too large (over "
+             << LILC::MAX_INPUT_SIZE << " bytes)\n";
+   return false;
+}
+
+/* Point the scanner at filename. Regular files are memory-mapped and
+ * scanned in place; "-" (stdin), pipes and anything else that can't be
+ * mapped are read as a stream instead. flex buffers streams itself; the
+ * hand-written scanner needs the whole input in memory first. */
+bool LILC::LilC_Compiler::openInput( const char * const filename )
+{
+   source.unmap();
+   inputText = std::string_view();
+   lines.reset( inputText );
+   if( flexScanner && flexLexer == nullptr ) {
+      flexLexer = new LILC::LilC_Scanner();
+   }
+   std::istream * in = &std::cin;
+   if( std::strcmp( filename, "-" ) != 0 ) {
+      if( source.map( filename ) ) {
+         if( source.size() > MAX_INPUT_SIZE ) {
+            source.unmap();
+            return inputTooLarge( filename );
+         }
+         inputText = std::string_view( source.data(), source.size() );
+         lines.reset( inputText );
+         if( flexScanner ) {
+            flexLexer->reset( &source );
+            scanner = flexLexer;
+         } else {
+            fastLexer.reset( source.data(), source.size() );
+            scanner = &fastLexer;
+         }
+         return true;
+      }
+      inStream.close();
+      inStream.clear();
+      inStream.open( filename );
+      if( ! inStream.good() ) {
+         return false;
+      }
+      in = &inStream;
+   }
+   if( flexScanner ) {
+      flexLexer->reset( in );
+      scanner = flexLexer;
+      return true;
+   }
+   inText.clear();
+   char chunk[64 * 1024];
+   while( in->read( chunk, sizeof( chunk ) ), in->gcount() > 0 ) {
+      inText.append( chunk, in->gcount() );
+      if( inText.size() > MAX_INPUT_SIZE ) {
+         inText.clear();
+         inText.shrink_to_fit();
+         return inputTooLarge( filename );
+      }
+   }
+   inputText = inText;
+   lines.reset( inputText );
+   fastLexer.reset( inText.data(), inText.size() );
+   scanner = &fastLexer;
+   return true;
+}
+
+bool LILC::LilC_Compiler::load( const char * const filename )
+{
+   if( loaded && loadedFile == filename )
+   {
+      return true;
+   }
+   loaded = false;
+   return openInput( filename ) && loadOpened( filename );
+}
+
+/* The rest of load(), once the input is open */
+bool LILC::LilC_Compiler::loadOpened( const char * const filename )
+{
+   if( isTokenFile( source ) )
+   {
+      //saved by scan( ..., true ); no need to scan it again. Its
+      //offsets are into a source we don't have.
+      lines.reset( std::string_view() );
+      tokens.clear();
+      if( ! readTokenFile( source, &tokens ) )
+      {
+         std::cerr << "Malformed token file " << filename << "\n";
+         return false;
+      }
+   }
+   else
+   {
+      lex();
+   }
+   loadedFile = filename;
+   loaded = true;
+   return true;
+}
+
+/* Scan the open input into tokens, in parallel if asked to */
+void LILC::LilC_Compiler::lex()
+{
+   tokens.clear();
+   if( inputText.size() > 0 )
+   {
+      //a rough guess at the token count, to skip most regrowth
+      tokens.reserve( inputText.size() / 4 );
+   }
+   if( threads != 1 && ! flexScanner )
+   {
+      if( pool == nullptr )
+      {
+         pool = new ThreadPool( threads );
+      }
+      tokenizeParallel( inputText.data(), inputText.size(), &tokens, *pool );
+   }
+   else
+   {
+      scanner->tokenize( &tokens );
+   }
 }
 
 void LILC::LilC_Compiler::scan( const char * const filename,
-const char * outfile )
+const char * outfile, bool binary )
 {
-   std::ifstream inStream( filename );
-   if( ! inStream.good() ) {
+   if( ! load( filename ) ) {
        exit( EXIT_FAILURE );
    }
 
-   delete(scanner);
-   scanner = new LILC::LilC_Scanner( &inStream );
+   BufferedWriter out;
+   if( ! out.open( outfile ) ) {
+       std::cerr << "Could not write to " << outfile << "\n";
+       exit( EXIT_FAILURE );
+   }
+   //a full disk or short write would otherwise leave a truncated dump
+   if( ( binary && ! writeTokenFile( tokens, out ) )
+      || ( ! binary && ! writeTokens( out ) ) || ! out.close() ) {
+       std::cerr << "Could not write to " << outfile << "\n";
+       exit( EXIT_FAILURE );
+   }
+}
 
-   std::ofstream out(outfile);
-   Lexeme lexeme;
-   int tokenTag;
-   while(true){
-   	tokenTag = scanner->yylex(&lexeme);
-	switch (tokenTag){
+/* The text form of the token stream, a token a line */
+bool LILC::LilC_Compiler::writeTokens( BufferedWriter &out )
+{
+   for( const TokenRec& tok : tokens ){
+	switch (tok.tag){
 		case TokenTag::END:
-			out << "EOF" << std::endl;
-			return;
+			out << "EOF\n";
+			return ! out.failed();
 		case TokenTag::BOOL:
-			out << "bool" << std::endl;
+			out << "bool\n";
 			break;
 		case TokenTag::INT:
-			out << "int" << std::endl;
+			out << "int\n";
 			break;
 		case TokenTag::VOID:
-			out << "void" << std::endl;
+			out << "void\n";
 			break;
 		case TokenTag::TRUE:
-			out << "true" << std::endl;
+			out << "true\n";
 			break;
 		case TokenTag::FALSE:
-			out << "false" << std::endl;
+			out << "false\n";
 			break;
 		case TokenTag::STRUCT:
-			out << "struct" << std::endl;
+			out << "struct\n";
 			break;
 		case TokenTag::INPUT:
-			out << "input" << std::endl;
+			out << "input\n";
 			break;
 		case TokenTag::OUTPUT:
-			out << "output" << std::endl;
+			out << "output\n";
 			break;
 		case TokenTag::IF:
-			out << "if" << std::endl;
+			out << "if\n";
 			break;
 		case TokenTag::ELSE:
-			out << "else" << std::endl;
+			out << "else\n";
 			break;
 		case TokenTag::WHILE:
-			out << "while" << std::endl;
+			out << "while\n";
 			break;
 		case TokenTag::RETURN:
-			out << "return" << std::endl;
+			out << "return\n";
 			break;
 		case TokenTag::ID:
-			{
-			IDToken * tok = (IDToken *)lexeme.tokenValue;
-			out << "ID:" << tok->value() << std::endl;
+			out << "ID:" << atomText(tok.payload) << '\n';
 			break;
-			}
 		case TokenTag::INTLITERAL:
-			{
-			IntLitToken * tok = (IntLitToken *)lexeme.tokenValue;
-			out << "INTLIT:" << tok->value() << std::endl;
+			out << "INTLIT:" << (int)tok.payload << '\n';
 			break;
-			}
 		case TokenTag::STRINGLITERAL:
-			{
-			StringLitToken * tok = (StringLitToken *)lexeme.tokenValue;
-			out << "STRINGLIT:" << tok->value() << std::endl;
+			out << "STRINGLIT:" << tokens.stringAt(tok.payload) << '\n';
 			break;
-			}
 		case TokenTag::LCURLY:
-			out << "{" << std::endl;
+			out << "{\n";
 			break;
 		case TokenTag::RCURLY:
-			out << "}" << std::endl;
+			out << "}\n";
 			break;
 		case TokenTag::LPAREN:
-			out << "(" << std::endl;
+			out << "(\n";
 			break;
 		case TokenTag::RPAREN:
-			out << ")" << std::endl;
+			out << ")\n";
 			break;
 		case TokenTag::SEMICOLON:
-			out << ";" << std::endl;
+			out << ";\n";
 			break;
 		case TokenTag::COMMA:
-			out << "," << std::endl;
+			out << ",\n";
 			break;
 		case TokenTag::DOT:
-			out << "." << std::endl;
+			out << ".\n";
 			break;
 		case TokenTag::WRITE:
-			out << "<<" << std::endl;
+			out << "<<\n";
 			break;
 		case TokenTag::READ:
-			out << ">>" << std::endl;
+			out << ">>\n";
 			break;
 		case TokenTag::PLUSPLUS:
-			out << "++" << std::endl;
+			out << "++\n";
 			break;
 		case TokenTag::MINUSMINUS:
-			out << "--" << std::endl;
+			out << "--\n";
 			break;
 		case TokenTag::PLUS:
-			out << "+" << std::endl;
+			out << "+\n";
 			break;
 		case TokenTag::MINUS:
-			out << "-" << std::endl;
+			out << "-\n";
 			break;
 		case TokenTag::TIMES:
-			out << "*" << std::endl;
+			out << "*\n";
 			break;
 		case TokenTag::DIVIDE:
-			out << "/" << std::endl;
+			out << "/\n";
 			break;
 		case TokenTag::NOT:
-			out << "!" << std::endl;
+			out << "!\n";
 			break;
 		case TokenTag::AND:
-			out << "&&" << std::endl;
+			out << "&&\n";
 			break;
 		case TokenTag::OR:
-			out << "||" << std::endl;
+			out << "||\n";
 			break;
 		case TokenTag::EQUALS:
-			out << "==" << std::endl;
+			out << "==\n";
 			break;
 		case TokenTag::NOTEQUALS:
-			out << "!=" << std::endl;
+			out << "!=\n";
 			break;
 		case TokenTag::LESS:
-			out << "<" << std::endl;
+			out << "<\n";
 			break;
 		case TokenTag::GREATER:
-			out << ">" << std::endl;
+			out << ">\n";
 			break;
 		case TokenTag::LESSEQ:
-			out << ">=" << std::endl;
+			out << ">=\n";
 			break;
 		case TokenTag::GREATEREQ:
-			out << ">=" << std::endl;
+			out << ">=\n";
 			break;
 		case TokenTag::ASSIGN:
-			out << "=" << std::endl;
+			out << "=\n";
 			break;
 		default:
-			out << "UNKNOWN TOKEN" << std::endl;
+			out << "UNKNOWN TOKEN\n";
 			break;
 	}
    }
+   return ! out.failed();
 }
 
 void
 LILC::LilC_Compiler::parse( const char * const infile) {
    assert( infile != nullptr );
-   std::ifstream in_stream( infile );
-   if( ! in_stream.good() )
+   dropTree();
+   //an input that has been parsed before comes from the cache,
+   //without being scanned
+   const bool useCache( flat && cache.enabled() && std::strcmp( infile, "-" ) != 0 );
+   uint64_t hash( 0 );
+   if( useCache )
+   {
+      loaded = false;
+      if( ! openInput( infile ) )
+      {
+         exit( EXIT_FAILURE );
+      }
+      hash = contentHash( inputText.data(), inputText.size() );
+      if( ! isTokenFile( source )
+         && cache.load( inputText, hash, &flatTree, &cacheFile ) )
+      {
+         return;
+      }
+      if( ! loadOpened( infile ) )
+      {
+         exit( EXIT_FAILURE );
+      }
+   }
+   else if( ! load( infile ) )
    {
        exit( EXIT_FAILURE );
    }
+   if( parseTokens() && useCache && ! isTokenFile( source )
+      && ! cache.store( inputText, hash, flatTree ) )
+   {
+      std::cerr << "Could not write to the AST cache\n";
+   }
+}
 
-   delete(scanner);
-   scanner = new LILC::LilC_Scanner( &in_stream );
-   delete(parser);
-   delete(astRoot);
-   try
+/* Parse the loaded tokens into a new tree */
+bool
+LILC::LilC_Compiler::parseTokens() {
+   cursor.rewind();
+   builder.setFlat( flat ? &flatTree : nullptr );
+   const int accept( 0 );
+   if( ! bisonParser )
    {
-      parser = new LILC::LilC_Parser( (*scanner) /* scanner */,
-                                  (*this) /* compiler */ );
+      DescentParser descent( tokens, (*this), builder );
+      if( lazyBodies && ! flat && streamOut == nullptr )
+      {
+         descent.setLazy( &bodies );
+      }
+      else
+      {
+         descent.setSource( this );
+      }
+      if( descent.parse() != accept )
+      {
+         parseFailed();
+         return false;
+      }
+      return true;
    }
-   catch( std::bad_alloc &ba )
+   if( parser == nullptr )
    {
-      std::cerr << "Failed to allocate parser: (" <<
-         ba.what() << "), exiting!!\n";
-      exit( EXIT_FAILURE );
+      try
+      {
+         parser = new LILC::LilC_Parser( cursor /* tokens */,
+                                     (*this) /* compiler */,
+                                     builder /* nodes */ );
+      }
+      catch( std::bad_alloc &ba )
+      {
+         std::cerr << "Failed to allocate parser: (" <<
+            ba.what() << "), exiting!!\n";
+         exit( EXIT_FAILURE );
+      }
    }
-   const int accept( 0 );
    if( parser->parse() != accept )
    {
-      std::cerr << "Parse failed!!\n";
+      parseFailed();
+      return false;
+   }
+   return true;
+}
+
+void
+LILC::LilC_Compiler::parseFailed() {
+   std::cerr << "Parse failed!!\n";
+   //the parser has destroyed its stack; the nodes built so far
+   //go now rather than at the next parse
+   dropTree();
+}
+
+/* The tree goes all at once */
+void
+LILC::LilC_Compiler::dropTree() {
+   astRoot = nullptr;
+   astArena.reset();
+   for( std::unique_ptr<Arena> &arena : bodyArenas )
+   {
+      arena->reset();
+   }
+   bodies.clear();
+   flatTree.clear();
+}
+
+/* Each thread parses a run of consecutive bodies, of about the same
+ * number of tokens as the others, into its own arena, and stops at its
+ * first error. The first failing run then holds the first error in the
+ * source, the one a full parse would have stopped at. */
+bool
+LILC::LilC_Compiler::parseBodies() {
+   if( bodies.empty() )
+   {
+      return true;
+   }
+   size_t runs = 1;
+   if( threads != 1 )
+   {
+      if( pool == nullptr )
+      {
+         pool = new ThreadPool( threads );
+      }
+      runs = std::min<size_t>( pool->size(), bodies.size() );
+   }
+   while( bodyArenas.size() < runs )
+   {
+      bodyArenas.emplace_back( new Arena( 1024 * 1024 ) );
+   }
+
+   struct Run
+   {
+      size_t begin, end;
+      bool failed = false;
+      uint32_t errorAt = 0;
+   };
+   std::vector<Run> work( runs );
+   size_t next = 0;
+   for( size_t r = 0; r < runs; r++ )
+   {
+      work[r].begin = next;
+      const size_t limit = tokens.size() * ( r + 1 ) / runs;
+      while( next < bodies.size() && ( bodies[next].token < limit || r + 1 == runs ) )
+      {
+         next++;
+      }
+      work[r].end = next;
+   }
+   auto parseRun = [this]( Run * run, Arena * arena ){
+      ASTBuilder build( *arena );
+      DescentParser descent( tokens, (*this), build );
+      for( size_t i = run->begin; i < run->end && ! run->failed; i++ )
+      {
+         run->failed = ! descent.parseBody( bodies[i], &run->errorAt );
+      }
+   };
+   if( runs == 1 )
+   {
+      parseRun( &work[0], bodyArenas[0].get() );
+   }
+   else
+   {
+      for( size_t r = 0; r < runs; r++ )
+      {
+         Run * run = &work[r];
+         Arena * arena = bodyArenas[r].get();
+         pool->submit( [parseRun, run, arena]{ parseRun( run, arena ); } );
+      }
+      pool->wait();
+   }
+
+   for( Run &run : work )
+   {
+      if( run.failed )
+      {
+         syntaxError( run.errorAt, "syntax error" );
+         parseFailed();
+         return false;
+      }
+   }
+   bodies.clear();
+   return true;
+}
+
+void
+LILC::LilC_Compiler::newSymbolTable() {
+   delete( symbolTable );
+   //nothing points into the old table's entries once its tree is gone
+   symbolEntries.reset();
+   localEntries.reset();
+   if( scopeList )
+   {
+      symbolTable = new ScopeListTable( symbolEntries );
+   }
+   else
+   {
+      symbolTable = new ScopeStackTable( symbolEntries );
+   }
+   symbolTable->setLocalEntries( &localEntries );
+}
+
+LILC::DeclList *
+LILC::LilC_Compiler::topLevelDecl( ASTBuilder &build, DeclList * decls, DeclNode * decl ) {
+   if( streamOut == nullptr )
+   {
+      return build.append( decls, decl );
+   }
+   //like DeclListNode::nameAnalysis, analyze nothing after the first
+   //failure; parsing goes on, to report any syntax error
+   if( streamPassed )
+   {
+      streamPassed = decl->nameAnalysis( symbolTable );
+      if( streamPassed )
+      {
+         decl->unparse( *streamOut, 0 );
+      }
+   }
+   //the symbol table holds nothing from the arena, and with decl
+   //unparsed, nothing points to the entries of its scopes. decls (or
+   //its handle) may be in the arena, so the list goes on out of it.
+   build.nodes().reset();
+   localEntries.reset();
+   //what follows is reported no earlier than decl
+   lines.discard( decl->offset() );
+   return &streamDecls;
+}
+
+/* Both parsers report their errors here. A streaming parse scans the
+ * rest of the input first, so that the scanner's diagnostics after the
+ * error still come before it, as when the whole input is scanned before
+ * parsing. */
+void
+LILC::LilC_Compiler::syntaxError( uint32_t offset, const char * message ) {
+   while( streamScanning )
+   {
+      tokens.drop();
+      streamScanning = scanner->tokenize( &tokens, STREAM_WINDOW );
+   }
+   size_t line, column;
+   if( lines.position( offset, &line, &column ) )
+   {
+      std::cerr << line << ":" << column << " ";
+   }
+   std::cerr << "Error: " << message << "\n";
+}
+
+bool
+LILC::LilC_Compiler::openStream( const char * const filename ) {
+   loaded = false;
+   if( ! openInput( filename ) )
+   {
+      return false;
+   }
+   if( isTokenFile( source ) )
+   {
+      return loadOpened( filename );
+   }
+   tokens.clear();
+   streamScanning = scanner->tokenize( &tokens, STREAM_WINDOW );
+   return true;
+}
+
+/* The parser is done with every token in the buffer, and so with the
+ * input before the last of them */
+bool
+LILC::LilC_Compiler::refill() {
+   if( ! streamScanning )
+   {
+      return false;
    }
+   //the line starts go in the table while the text is still there
+   lines.extend( tokens[tokens.size() - 1].offset );
+   source.release( tokens[tokens.size() - 1].offset );
+   tokens.drop();
+   streamScanning = scanner->tokenize( &tokens, STREAM_WINDOW );
+   return true;
+}
+
+/* The output goes to a file beside outfile, renamed over it once the
+ * whole input has parsed and passed. */
+void
+LILC::LilC_Compiler::streamAnalysis( const char * const infile, const char * const outfile ) {
+   dropTree();
+   if( ! openStream( infile ) )
+   {
+      exit( EXIT_FAILURE );
+   }
+   const std::string temp( std::string( outfile ) + ".partial" );
+   std::ofstream out( temp );
+   if( ! out.good() )
+   {
+      std::cerr << "Could not write to " << temp << "\n";
+      streamScanning = false;
+      return;
+   }
+   newSymbolTable();
+   //what ProgramNode::nameAnalysis does first
+   symbolTable->addScope();
+   ASTNode::setLineTable( &lines );
+   streamOut = &out;
+   streamPassed = true;
+   this->parseTokens();
+   streamOut = nullptr;
+   streamScanning = false;
+   tokens.clear();
+   out.close();
+   if( this->astRoot == nullptr || ! streamPassed || out.fail()
+      || std::rename( temp.c_str(), outfile ) != 0 )
+   {
+      std::remove( temp.c_str() );
+   }
+   dropTree();
 }
 
 void
 LILC::LilC_Compiler::nameAnalysis( const char * const infile, const char * const outfile ) {
+	if (streaming && !flat) {
+		streamAnalysis(infile, outfile);
+		return;
+	}
 	this->parse(infile);
-	delete( symbolTable);
-	symbolTable = new SymbolTable();
+	if (flat) {
+		if (flatTree.root() == FlatAST::NoNode) {
+			return;
+		}
+		newSymbolTable();
+		if (flatTree.nameAnalysis(symbolTable, &lines)) {
+			std::ofstream out(outfile);
+			flatTree.unparse(out, 0);
+		}
+		return;
+	}
+	if (this->astRoot == nullptr || !this->parseBodies()) {
+		return;
+	}
+	newSymbolTable();
+	ASTNode::setLineTable( &lines );
   bool result = this->astRoot->nameAnalysis(symbolTable);
   if (result) {
     std::ofstream out(outfile);
@@ -4,16 +4,32 @@
 #include <string>
 #include <cstddef>
 #include <istream>
+#include <fstream>
+#include <memory>
+#include <vector>
 
-#include "lilc_scanner.hpp"
+#include "lexer.hpp"
+#include "fast_scanner.hpp"
 #include "tokens.hpp"
 #include "ast.hpp"
+#include "ast_builder.hpp"
+#include "flat_ast.hpp"
+#include "ast_cache.hpp"
+#include "descent_parser.hpp"
 #include "grammar.hh"
 #include "symbol_table.hpp"
+#include "source_file.hpp"
+#include "line_table.hpp"
+#include "token_buffer.hpp"
+#include "token_cursor.hpp"
+#include "thread_pool.hpp"
+#include "buffered_writer.hpp"
 
 namespace LILC{
 
-class LilC_Compiler{
+class LilC_Scanner;
+
+class LilC_Compiler : private TokenSource{
 public:
    LilC_Compiler() = default;
 
@@ -22,14 +38,137 @@ public:
    void setASTRoot(ProgramNode * root){ this->astRoot = root; }
    ProgramNode * getASTRoot(){ return this->astRoot; }
 
-   void scan( const char * const filename, const char * outfile);
+   // Write the token stream of filename to outfile, as text or in
+   // the binary format of token_file.hpp. parse() accepts the latter
+   // in place of source.
+   void scan( const char * const filename, const char * outfile, bool binary = false );
    void parse( const char * const filename );
+
+   // Lex filename into the token buffer, unless it is what's already
+   // there. scan() and parse() both start here, so dumping the tokens
+   // of a file and then parsing it only lexes it once.
+   bool load( const char * const filename );
    void nameAnalysis( const char * const filename, const char * outfile );
+
+   // Positions of the offsets in the current input, for diagnostics
+   LineTable& lineTable(){ return this->lines; }
+   // Report a syntax error at offset, for either parser
+   void syntaxError( uint32_t offset, const char * message );
+
+   // Parse into a FlatAST, and analyze and unparse that, instead of
+   // a tree of ASTNodes
+   void setFlatAST( bool flat ){ this->flat = flat; }
+   FlatAST& flatAST(){ return this->flatTree; }
+
+   // Have parse() skip function bodies, leaving their FnBodyNodes
+   // empty, and parse them in parseBodies(), on the scanning threads;
+   // nameAnalysis does both. Only for the hand-written parser building
+   // a tree of ASTNodes; otherwise parse() parses everything.
+   void setLazyBodies( bool lazy ){ this->lazyBodies = lazy; }
+   // Returns false, having reported the first syntax error, if a body
+   // doesn't parse. The tree is dropped then, as after parse() fails.
+   bool parseBodies();
+
+   // Keep each input's tree in dir, under a hash of its text, and
+   // take it from there instead of scanning and parsing the input
+   // again while the text is unchanged. The cache holds FlatASTs, so it
+   // is only used with setFlatAST( true ).
+   void setCacheDirectory( const std::string &dir ){ cache.setDirectory( dir ); }
+
+   // Have nameAnalysis analyze and unparse each top-level declaration
+   // as soon as it is parsed, and then free its nodes, so the tree
+   // never holds more than one declaration. The output is the same,
+   // and is still only written if every declaration passes; but name
+   // errors before a syntax error are reported, where a whole parse
+   // would report the syntax error alone. Only for the tree of
+   // ASTNodes, and bodies are not parsed lazily. The input is scanned
+   // a window at a time, as the parser gets to it, on one thread, and
+   // each window is freed once parsed, so memory depends on the
+   // largest declaration rather than on the input. (A token file is
+   // still read whole, and so is a stream for the hand-written
+   // scanner.)
+   void setStreaming( bool stream ){ this->streaming = stream; }
+   // The parsers' declList action: adds decl to decls with build and
+   // returns the list, or when streaming, analyzes, unparses and drops
+   // it and returns an empty list
+   DeclList * topLevelDecl( ASTBuilder &build, DeclList * decls, DeclNode * decl );
+
+   // Parse with the bison parser (the default), or with the
+   // hand-written one when false
+   void setBisonParser( bool bison ){ this->bisonParser = bison; }
+   // Look names up in a ScopeListTable, scope by scope (the default),
+   // or in a ScopeStackTable when false
+   void setScopeListTable( bool list ){ this->scopeList = list; }
+   // Scan with the flex scanner (the default), or with the hand-written
+   // one when false
+   void setFlexScanner( bool flex ){ this->flexScanner = flex; }
+   // Scan large inputs in line-aligned chunks on this many threads
+   // (0 for one per hardware thread). Needs the hand-written scanner.
+   void setThreads( unsigned threads ){ this->threads = threads; }
 private:
+   bool openInput( const char * const filename );
+   void lex();
+   bool loadOpened( const char * const filename );
+   bool parseTokens();
+   bool writeTokens( BufferedWriter &out );
+   void streamAnalysis( const char * const infile, const char * const outfile );
+   // load(), but only the first window of the input when streaming
+   bool openStream( const char * const filename );
+   // the parsers' TokenSource while streaming
+   bool refill();
+   // replaces symbolTable with an empty one
+   void newSymbolTable();
+   void parseFailed();
+   void dropTree();
+
+   // Built once and reused for every input
    LILC::LilC_Parser  *parser  = nullptr;
-   LILC::LilC_Scanner *scanner = nullptr;
+   LILC::LilC_Scanner *flexLexer = nullptr;
+   LILC::LilC_FastScanner fastLexer;
+   LILC::Lexer        *scanner = nullptr;
    ProgramNode * astRoot = nullptr;
+   // every node of astRoot's tree
+   Arena astArena{ 1024 * 1024 };
+   FlatAST flatTree;
+   ASTCache cache;
+   // the cache file flatTree was loaded from, if it was
+   SourceFile cacheFile;
+   ASTBuilder builder{ astArena };
+   bool flat = false;
+   bool bisonParser = true;
+   bool lazyBodies = false;
+   bool streaming = false;
+   // while streaming: where declarations are unparsed to, and whether
+   // every one so far has passed name analysis
+   std::ofstream * streamOut = nullptr;
+   bool streamPassed = true;
+   // the scanner has yet to reach the end of the streamed input
+   bool streamScanning = false;
+   // what topLevelDecl returns while streaming; it stays empty
+   DeclList streamDecls;
+   // bodies parse() skipped, and the arenas parseBodies() parses them
+   // into, one per thread
+   std::vector<LazyBody> bodies;
+   std::vector<std::unique_ptr<Arena>> bodyArenas;
    SymbolTable * symbolTable = nullptr;
+   // the entries of symbolTable's outermost scope, and of the scopes
+   // inside it; when streaming, the latter go after each declaration
+   Arena symbolEntries{ 64 * 1024 };
+   Arena localEntries{ 64 * 1024 };
+   bool scopeList = true;
+   SourceFile source;
+   std::ifstream inStream;
+   std::string inText;
+   std::string_view inputText;
+   LineTable lines;
+   bool flexScanner = true;
+   unsigned threads = 1;
+   ThreadPool * pool = nullptr;
+   TokenBuffer tokens;
+   TokenCursor cursor{tokens, this};
+   // what's in tokens
+   std::string loadedFile;
+   bool loaded = false;
 };
 
 } /* end namespace */
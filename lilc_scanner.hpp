@@ -5,45 +5,108 @@
 #include <FlexLexer.h>
 #endif
 
+#include <deque>
+#include <string>
+#include <string_view>
+
 #include "grammar.hh"
+#include "lexer.hpp"
+#include "source_file.hpp"
+#include "token_buffer.hpp"
 
 namespace LILC{
 
-class LilC_Scanner : public yyFlexLexer{
+class LilC_Scanner : public yyFlexLexer, public Lexer{
 public:
    
    LilC_Scanner(std::istream *in) : yyFlexLexer(in)
    {
    };
+   // Scan directly out of a mapped file; tokens refer to its bytes
+   LilC_Scanner(const SourceFile *source = nullptr) : yyFlexLexer(nullptr)
+   {
+	this->source = source;
+   };
    virtual ~LilC_Scanner() {
    };
 
    //get rid of override virtual function warning
    using FlexLexer::yylex;
 
+   // Start over on another input, keeping flex's buffers
+   void reset( std::istream *in ){
+	this->source = nullptr;
+	restart();
+	yyrestart( in );
+   }
+   void reset( const SourceFile *source ){
+	this->source = source;
+	restart();
+	yyrestart( nullptr );
+   }
+
    // YY_DECL defined in the flex file.l
    virtual
-   int yylex( LILC::LilC_Parser::semantic_type * const lval);
-
-   void warn(int lineNum, int charNum, std::string msg){
-	std::cerr << lineNum << ":" << charNum << " ***WARNING*** " << msg << std::endl;
-   }
+   int yylex( Token ** const token );
 
-   void error(int lineNum, int charNum, std::string msg){
-	std::cerr << lineNum << ":" << charNum << " ***ERROR*** " << msg << std::endl;
-   }
+   // Scan the whole input into out instead of handing back one heap
+   // allocated Token per yylex call. Always ends with an END token.
+   void tokenize( TokenBuffer * out );
+   bool tokenize( TokenBuffer * out, size_t bytes );
 
    int produceNullaryToken(int tag){
-	this->yylval->tokenValue = new NullaryToken(lineNum, charNum, tag);
+	if (tokens != nullptr){
+		tokens->push(tag, byteNum);
+	} else {
+		*this->yylval = new NullaryToken(byteNum, tag);
+	}
 	charNum += yyleng;
 	return tag;
    }
+   //Defined in lilc.l
+   int produceIDToken();
+   int produceIntLitToken(int value);
+   int produceStrLitToken();
+
+   // The text of the current match. When scanning a mapped file this
+   // points into the mapping; on the stream path there is nothing
+   // stable to point at, so the text is copied and kept alive here
+   // (or in the token buffer, when there is one).
+   std::string_view lexeme(){
+	if (source != nullptr){
+		return source->text(byteNum, yyleng);
+	}
+	if (tokens != nullptr){
+		return tokens->copyText(yytext, yyleng);
+	}
+	copies.emplace_back(yytext, yyleng);
+	return copies.back();
+   }
+
+protected:
+   int LexerInput(char * buf, int max_size);
+
+   void restart(){
+	Lexer::restart();
+	byteNum = 0;
+	nextByteNum = 0;
+	sourcePos = 0;
+	copies.clear();
+   }
 
 private:
-   /* yyval ptr */
-   LILC::LilC_Parser::semantic_type *yylval = nullptr;
-   size_t lineNum;
-   size_t charNum;
+   /* where yylex puts the Token it makes */
+   Token ** yylval = nullptr;
+   /* byte offset of the current match, and of the next one */
+   size_t byteNum = 0;
+   size_t nextByteNum = 0;
+   const SourceFile *source = nullptr;
+   /* set while tokenize() is running */
+   TokenBuffer *tokens = nullptr;
+   /* how much of source (or of the stream) has been handed to flex
+    * so far */
+   size_t sourcePos = 0;
+   std::deque<std::string> copies;
 };
 
 } /* end namespace */
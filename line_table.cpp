@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <cstring>
+
+#include "line_table.hpp"
+
+namespace LILC{
+
+void LineTable::extend(size_t end){
+	end = std::min(end, myText.size());
+	if (end <= myScanned) {
+		return;
+	}
+	const char * begin = myText.data();
+	const char * stop = begin + end;
+	const char * pos = begin + myScanned;
+	while (pos < stop) {
+		const char * nl = (const char *)memchr(pos, '\n', stop - pos);
+		if (nl == nullptr) {
+			break;
+		}
+		pos = nl + 1;
+		myStarts.push_back(pos - begin);
+	}
+	myScanned = end;
+}
+
+void LineTable::discard(uint32_t offset){
+	//keep the line holding offset
+	auto next = std::upper_bound(myStarts.begin(), myStarts.end(), offset);
+	if (next - myStarts.begin() > 1) {
+		myDiscarded += (next - myStarts.begin()) - 1;
+		myStarts.erase(myStarts.begin(), next - 1);
+	}
+}
+
+bool LineTable::position(uint32_t offset, size_t * line, size_t * column){
+	if (myText.empty() || offset < myStarts.front()) {
+		return false;
+	}
+	//a newline at offset starts the next line, not this one
+	extend(size_t(offset) + 1);
+	//the last line starting at or before offset
+	auto next = std::upper_bound(myStarts.begin(), myStarts.end(), offset);
+	size_t index = (next - myStarts.begin()) - 1;
+	*line = myDiscarded + index + 1;
+	*column = offset - myStarts[index] + 1;
+	return true;
+}
+
+}
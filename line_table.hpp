@@ -0,0 +1,50 @@
+#ifndef LILC_LINE_TABLE_HPP
+#define LILC_LINE_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace LILC{
+
+//Offsets are 32 bits, so an input can be no longer than this
+constexpr size_t MAX_INPUT_SIZE = UINT32_MAX;
+
+//Tokens and AST nodes only record the byte offset where they start;
+// this maps an offset back to a line and column for a diagnostic. Line
+// starts are only found as far as a lookup needs them, so inputs
+// without errors never pay for the table. A streaming parse records
+// them as it goes instead, with extend() before it releases the text
+// and discard() once it is done with the lines before an offset.
+class LineTable{
+public:
+	void reset(std::string_view text){
+		myText = text;
+		myStarts.assign(1, 0);
+		myScanned = 0;
+		myDiscarded = 0;
+	}
+
+	// Sets the 1-based line and column of the byte at offset. Returns
+	// false if there is no source text to look in (e.g. the input was
+	// a token file, or was read by flex as a stream), or if the line
+	// has been discarded.
+	bool position(uint32_t offset, size_t * line, size_t * column);
+
+	// records the line starts in the text before end
+	void extend(size_t end);
+	// forgets the starts of the lines wholly before offset
+	void discard(uint32_t offset);
+
+private:
+	std::string_view myText;
+	// the starts of lines myDiscarded + 1 onward
+	std::vector<uint32_t> myStarts;
+	// the text before here has been searched for line starts
+	size_t myScanned = 0;
+	size_t myDiscarded = 0;
+};
+
+}
+#endif
@@ -5,14 +5,14 @@ namespace LILC{
 
 bool ProgramNode::nameAnalysis(SymbolTable * symTab){
 	symTab->addScope();
-	this->myDeclList->nameAnalysis(symTab);
+	return this->myDeclList->nameAnalysis(symTab);
 }
 
 bool DeclListNode::nameAnalysis(SymbolTable * symTab){
 	bool result = true;
-	for (std::list<DeclNode *>::iterator
-		it=myDecls->begin();
-		it != myDecls->end(); ++it){
+	for (DeclSpan::iterator
+		it=myDecls.begin();
+		it != myDecls.end(); ++it){
 
 	  DeclNode * elt = *it;
 	  result = result && elt->nameAnalysis(symTab);
@@ -22,39 +22,42 @@ bool DeclListNode::nameAnalysis(SymbolTable * symTab){
 
 bool VarDeclNode::nameAnalysis(SymbolTable * symTab){
 	if (mySize == NOT_STRUCT) {
-		bool result = symTab->addSymbol(myId->getId(), Var, myType->getType(), mySize);
+		bool result = symTab->addSymbol(myId->getAtom(), Var, myType->getType(),
+		  StructLayout::sizeOf(myType->getType()));
 
 		if (!result) {
-			reportError("Multiply declared identifier", myId->getId());
+			myId->reportError("Multiply declared identifier", myId->getId());
 		}
 
-		if (myType->getType().compare("void") == 0) {
-			reportError("Non-function declared void", myId->getId());
+		if (myType->getType() == TypeTable::global().voidType()) {
+			myId->reportError("Non-function declared void", myId->getId());
 			result = false;
 		}
 
 		return result;
 	}
 
+	Atom structName = myType->getType()->structName();
 	SymbolTableEntry* entry;
 	if (symTab->getGlobalScope() == nullptr) {
-		entry = symTab->findEntry(myType->getType());
+		entry = symTab->findEntry(structName);
 	} else {
-		entry = symTab->getGlobalScope()->findEntry(myType->getType());
+		entry = symTab->getGlobalScope()->findEntry(structName);
 	}
 
 	if (entry->getKind() != Struct) {
 		reportError("Invalid name of struct type", myId->getId());
 		return false;
 	}
-	return symTab->addSymbol(myId->getId(), Struct, myType->getType(), mySize);
+	return symTab->addSymbol(myId->getAtom(), Struct, myType->getType(),
+	  StructLayout::sizeOf(entry));
 }
 
 bool FormalsListNode::nameAnalysis(SymbolTable * symTab){
 	bool result = true;
-	for (std::list<FormalDeclNode *>::iterator
-		it=myFormals->begin();
-		it != myFormals->end(); ++it){
+	for (FormalsSpan::iterator
+		it=myFormals.begin();
+		it != myFormals.end(); ++it){
 
 	  FormalDeclNode * elt = *it;
 	  result = result && elt->nameAnalysis(symTab);
@@ -64,7 +67,7 @@ bool FormalsListNode::nameAnalysis(SymbolTable * symTab){
 
 bool ExpListNode::nameAnalysis(SymbolTable * symTab){
 	bool result = true;
-	for (std::list<ExpNode *>::iterator
+	for (ExpSpan::iterator
 		it = myExps.begin();
 		it != myExps.end(); ++it){
 
@@ -76,9 +79,9 @@ bool ExpListNode::nameAnalysis(SymbolTable * symTab){
 
 bool StmtListNode::nameAnalysis(SymbolTable * symTab){
 	bool result = true;
-	for (std::list<StmtNode *>::iterator
-		it=myStmts->begin();
-		it != myStmts->end(); ++it){
+	for (StmtSpan::iterator
+		it=myStmts.begin();
+		it != myStmts.end(); ++it){
 
 	  StmtNode * elt = *it;
 	  result = result && elt->nameAnalysis(symTab);
@@ -88,12 +91,12 @@ bool StmtListNode::nameAnalysis(SymbolTable * symTab){
 
 bool FnBodyNode::nameAnalysis(SymbolTable * symTab){
 	myDeclList->nameAnalysis(symTab);
-	myStmtList->nameAnalysis(symTab);
+	return myStmtList->nameAnalysis(symTab);
 }
 
 bool FnDeclNode::nameAnalysis(SymbolTable * symTab){
-	std::string type = myFormals->getTypes() + "->" + myType->getType();
-	bool result = symTab->addSymbol(myId->getId(), Func, type, -1);
+	const Type * type = TypeTable::global().function(myFormals->getTypes(), myType->getType());
+	bool result = symTab->addSymbol(myId->getAtom(), Func, type, -1);
 	symTab->addScope();
 	result = result && myFormals->nameAnalysis(symTab);
 	result = result && myBody->nameAnalysis(symTab);
@@ -102,14 +105,20 @@ bool FnDeclNode::nameAnalysis(SymbolTable * symTab){
 }
 
 bool FormalDeclNode::nameAnalysis(SymbolTable * symTab){
-	return symTab->addSymbol(myId->getId(), Var, myType->getType(), -1);
+	return symTab->addSymbol(myId->getAtom(), Var, myType->getType(),
+	  StructLayout::sizeOf(myType->getType()));
 }
 
 bool StructDeclNode::nameAnalysis(SymbolTable * symTab){
-	bool result = symTab->addSymbol(myId->getId(), Struct, "struct", -1);
-	SymbolTable* structTable = symTab->findEntry(myId->getId())->getStructScope();
+	bool result = symTab->addSymbol(myId->getAtom(), Struct, TypeTable::global().structName(), -1);
+	SymbolTableEntry* entry = symTab->findEntry(myId->getAtom());
+	SymbolTable* structTable = symTab->getStructScope(entry);
 	structTable->setGlobalScope(symTab);
-	result = result && myDeclList->nameAnalysis(structTable);
+	if (!result) {
+		return false;
+	}
+	result = myDeclList->nameAnalysis(structTable);
+	symTab->setLayout(entry);
 	return result;
 }
 
@@ -138,9 +147,9 @@ bool StrLitNode::nameAnalysis(SymbolTable * symTab){
 }
 
 bool IdNode::nameAnalysis(SymbolTable * symTab){
-	myEntry = symTab->findEntry(myStrVal);
+	myEntry = symTab->findEntry(myAtom);
 	if (myEntry->getKind() == NotFound) {
-		reportError("Undeclared identifier", myStrVal);
+		reportError("Undeclared identifier", getId());
 		return false;
 	}
 	return true;
@@ -161,22 +170,23 @@ bool DotAccessNode::nameAnalysis(SymbolTable * symTab){
 		return false;
 	}
 	if (structEntry->getKind() != Struct) {
-		reportError("Dot-access of non-struct type", structEntry->getId());
+		reportError("Dot-access of non-struct type",
+		  std::string(atomText(structEntry->getId())));
 		result = false;
 	}
-	if (structEntry->getType().compare("struct") != 0) {
-		structEntry = symTab->findEntry(structEntry->getType());
+	if (structEntry->getType() != TypeTable::global().structName()) {
+		structEntry = symTab->findStruct(structEntry->getType());
 	}
 
 
-	SymbolTableEntry* entry = structEntry->getStructScope()->findEntry(myId->getId());
+	SymbolTableEntry* entry = structEntry->findField(myId->getAtom());
 	if (entry->getKind() == NotFound) {
-		reportError("Invalid struct field name", myId->getId());
+		myId->reportError("Invalid struct field name", myId->getId());
 		result = false;
 	} else {
-		result = result && myId->nameAnalysis(structEntry->getStructScope());
+		myId->setEntry(entry);
 	}
-	structEntry = symTab->findEntry(entry->getType());
+	structEntry = symTab->findStruct(entry->getType());
 
 	return result;
 }
@@ -201,62 +211,7 @@ bool NotNode::nameAnalysis(SymbolTable * symTab){
 	return myExp->nameAnalysis(symTab);
 }
 
-bool PlusNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool MinusNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool TimesNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool DivideNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool AndNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool OrNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool EqualsNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool NotEqualsNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool LessNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool GreaterNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool LessEqNode::nameAnalysis(SymbolTable * symTab){
-	bool result = myExp1->nameAnalysis(symTab);
-	return (result && myExp2->nameAnalysis(symTab));
-}
-
-bool GreaterEqNode::nameAnalysis(SymbolTable * symTab){
+bool BinaryExpNode::nameAnalysis(SymbolTable * symTab){
 	bool result = myExp1->nameAnalysis(symTab);
 	return (result && myExp2->nameAnalysis(symTab));
 }
@@ -319,6 +274,9 @@ bool CallStmtNode::nameAnalysis(SymbolTable * symTab){
 }
 
 bool ReturnStmtNode::nameAnalysis(SymbolTable * symTab){
+	if (myExp == nullptr) {
+		return true;
+	}
 	return myExp->nameAnalysis(symTab);
 }
 
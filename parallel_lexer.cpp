@@ -0,0 +1,121 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "parallel_lexer.hpp"
+#include "fast_scanner.hpp"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+//Below this a chunk costs more to hand off than to scan
+static const size_t MIN_CHUNK = 256 * 1024;
+
+struct Chunk{
+	size_t begin;
+	size_t end;
+	TokenBuffer tokens;
+	AtomTable atoms;
+	std::vector<Diagnostic> diagnostics;
+	//newlines scanned; only meaningful if the chunk ran to its end
+	size_t lines = 0;
+	//a rejected string literal stopped the scan before the end
+	bool stopped = false;
+};
+
+static void scanChunk(const char * text, Chunk * chunk){
+	size_t length = chunk->end - chunk->begin;
+	LilC_FastScanner scanner(text + chunk->begin, length);
+	scanner.setAtoms(&chunk->atoms);
+	scanner.holdDiagnostics(&chunk->diagnostics);
+	chunk->tokens.reserve(length / 4 + 1);
+	scanner.tokenize(&chunk->tokens);
+	chunk->lines = scanner.line() - 1;
+	const TokenRec& end = chunk->tokens[chunk->tokens.size() - 1];
+	chunk->stopped = end.offset < length;
+}
+
+void tokenizeParallel(const char * text, size_t size, TokenBuffer * out,
+  ThreadPool& pool){
+	size_t count = size / MIN_CHUNK;
+	if (count > pool.size()) {
+		count = pool.size();
+	}
+	if (count < 2) {
+		LilC_FastScanner scanner(text, size);
+		scanner.tokenize(out);
+		return;
+	}
+
+	//Cut just after the first newline past each even split point
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	size_t begin = 0;
+	for (size_t i = 1; i <= count && begin < size; i++) {
+		size_t end = size;
+		if (i < count) {
+			size_t guess = size / count * i;
+			if (guess < begin) {
+				guess = begin;
+			}
+			const void * newline = memchr(text + guess, '\n', size - guess);
+			if (newline != nullptr) {
+				end = static_cast<const char *>(newline) - text + 1;
+			}
+		}
+		std::unique_ptr<Chunk> chunk(new Chunk());
+		chunk->begin = begin;
+		chunk->end = end;
+		chunks.push_back(std::move(chunk));
+		begin = end;
+	}
+
+	for (std::unique_ptr<Chunk>& chunk : chunks) {
+		Chunk * work = chunk.get();
+		pool.submit([text, work]{ scanChunk(text, work); });
+	}
+	pool.wait();
+
+	size_t total = 0;
+	for (std::unique_ptr<Chunk>& chunk : chunks) {
+		total += chunk->tokens.size();
+	}
+	out->reserve(total);
+
+	//Interning each chunk's atoms in chunk order, and each chunk's in
+	// first-seen order, numbers them as a single scan would have.
+	size_t linesBefore = 0;
+	std::vector<Atom> globalAtoms;
+	for (std::unique_ptr<Chunk>& chunk : chunks) {
+		globalAtoms.resize(chunk->atoms.size());
+		for (Atom local = 0; local < chunk->atoms.size(); local++) {
+			globalAtoms[local] = AtomTable::global().intern(chunk->atoms.text(local));
+		}
+		size_t last = chunk->tokens.size() - 1;
+		for (size_t i = 0; i < last; i++) {
+			const TokenRec& tok = chunk->tokens[i];
+			uint32_t payload = tok.payload;
+			if (tok.tag == TokenTag::ID) {
+				payload = globalAtoms[payload];
+			} else if (tok.tag == TokenTag::STRINGLITERAL) {
+				payload = out->addString(chunk->tokens.stringAt(payload));
+			}
+			out->push(tok.tag, tok.offset + chunk->begin, payload);
+		}
+		for (Diagnostic& diag : chunk->diagnostics) {
+			//the integer-overflow warning is always reported at 0:0
+			if (diag.line != 0) {
+				diag.line += linesBefore;
+			}
+			Lexer::print(diag);
+		}
+		if (chunk->stopped) {
+			out->push(TokenTag::END, chunk->tokens[last].offset + chunk->begin);
+			return;
+		}
+		linesBefore += chunk->lines;
+	}
+	out->push(TokenTag::END, size);
+}
+
+}
@@ -0,0 +1,21 @@
+#ifndef LILC_PARALLEL_LEXER_HPP
+#define LILC_PARALLEL_LEXER_HPP
+
+#include <cstddef>
+
+#include "thread_pool.hpp"
+#include "token_buffer.hpp"
+
+namespace LILC{
+
+//No LIL'C token spans a newline, so an input can be cut at line
+// boundaries and each piece scanned by its own LilC_FastScanner. The
+// pieces are stitched back into out with the same tokens, atoms and
+// diagnostics (in the same order) that one scanner over the whole
+// input would give. Inputs too small to be worth splitting are just
+// scanned on the calling thread.
+void tokenizeParallel(const char * text, size_t size, TokenBuffer * out,
+  ThreadPool& pool);
+
+}
+#endif
@@ -0,0 +1,130 @@
+// Checks relex against a full rescan: makes random edits to a LIL'C
+// input, brings its tokens up to date with relex after each one, and
+// compares them with the tokens of the edited input scanned from
+// scratch. "make check-relex" runs it on a small corpus from gen_corpus.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "incremental_lexer.hpp"
+#include "fast_scanner.hpp"
+
+using namespace LILC;
+using TokenTag = LILC::LilC_Parser::token;
+
+// what edits insert: tokens, bits of tokens, and the characters that
+// end lines, strings and comments early
+static const char * const FRAGMENTS[] = {
+	"int ", "bool", "x", "ab1", "_", " ", "  ", "\n", "\n\n", ";", "{", "}",
+	"(", ")", ".", "=", "==", "<", "<<", ">>", "+", "++", "-", "!", "&&",
+	"||", "/", "//", "#", "\"", "\"str\"", "\"a\\n\"", "\\", "\\q", "?",
+	"@", "0", "42", "99999999999", "struct ", "while", "return",
+};
+
+static int usage(){
+	std::cout << "Usage: relex_check [--edits=N] [--seed=N] <infile>" << std::endl;
+	return 1;
+}
+
+static void scan(const std::string& text, TokenBuffer * tokens){
+	std::vector<Diagnostic> unused;
+	LilC_FastScanner scanner(text.data(), text.size());
+	scanner.holdDiagnostics(&unused);
+	tokens->clear();
+	tokens->setCopyStrings(true);
+	scanner.tokenize(tokens);
+}
+
+// the index of the first token that differs, or -1 if none does
+static long firstDifference(const TokenBuffer& a, const TokenBuffer& b){
+	size_t count = a.size() < b.size() ? a.size() : b.size();
+	for (size_t i = 0; i < count; i++) {
+		const TokenRec& x = a[i];
+		const TokenRec& y = b[i];
+		if (x.tag != y.tag || x.offset != y.offset) {
+			return i;
+		}
+		if (x.tag == TokenTag::STRINGLITERAL
+		  ? a.stringAt(x.payload) != b.stringAt(y.payload)
+		  : x.payload != y.payload) {
+			return i;
+		}
+	}
+	return a.size() == b.size() ? -1 : (long)count;
+}
+
+int main(int argc, char ** argv){
+	long edits = 15000;
+	unsigned seed = 1;
+	int arg = 1;
+	for (; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; arg++) {
+		if (std::strncmp(argv[arg], "--edits=", 8) == 0) {
+			edits = std::atol(argv[arg] + 8);
+		} else if (std::strncmp(argv[arg], "--seed=", 7) == 0) {
+			seed = std::atoi(argv[arg] + 7);
+		} else {
+			return usage();
+		}
+	}
+	if (argc - arg != 1) {
+		return usage();
+	}
+	std::ifstream in(argv[arg]);
+	if (!in.good()) {
+		std::cout << "Could not read " << argv[arg] << std::endl;
+		return 1;
+	}
+	const std::string original((std::istreambuf_iterator<char>(in)),
+	  std::istreambuf_iterator<char>());
+	//relex reports the diagnostics of the lines it rescans; they are
+	//not what is checked here
+	std::cerr.rdbuf(nullptr);
+
+	std::mt19937 generator(seed);
+	std::string text = original;
+	TokenBuffer tokens;
+	TokenBuffer expected;
+	scan(text, &tokens);
+	for (long i = 0; i < edits; i++) {
+		//Start over now and then: a bad string literal ends a scan, so
+		//once one is in, edits after it aren't scanned at all. This
+		//also keeps the input about the size it started at.
+		if (i % 64 == 0 || text.size() > 2 * original.size() + 64) {
+			text = original;
+			scan(text, &tokens);
+		}
+		TextEdit edit;
+		edit.offset = generator() % (text.size() + 1);
+		edit.removed = generator() % 9;
+		if (edit.removed > text.size() - edit.offset) {
+			edit.removed = text.size() - edit.offset;
+		}
+		std::string inserted;
+		for (unsigned n = generator() % 4; n > 0; n--) {
+			inserted += FRAGMENTS[generator() % (sizeof(FRAGMENTS) / sizeof(FRAGMENTS[0]))];
+		}
+		edit.inserted = inserted.size();
+		const std::string before = text;
+		text.replace(edit.offset, edit.removed, inserted);
+
+		relex(&tokens, text.data(), text.size(), edit);
+		scan(text, &expected);
+		long at = firstDifference(tokens, expected);
+		if (at >= 0) {
+			std::cout << "edit " << i << " (seed " << seed << "): replacing "
+			  << edit.removed << " bytes at " << edit.offset << " with \""
+			  << inserted << "\" left token " << at << " different from a"
+			  << " full rescan\n--- before:\n" << before << "\n--- after:\n"
+			  << text << std::endl;
+			return 1;
+		}
+	}
+	std::cout << edits << " edits, relex agreed with a full rescan" << std::endl;
+	return 0;
+}
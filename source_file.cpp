@@ -0,0 +1,63 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "source_file.hpp"
+
+namespace LILC{
+
+SourceFile::~SourceFile(){
+	unmap();
+}
+
+bool SourceFile::map(const char * filename){
+	unmap();
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+		close(fd);
+		return false;
+	}
+	if (info.st_size == 0) {
+		//mmap refuses zero-length mappings
+		close(fd);
+		myData = "";
+		return true;
+	}
+	void * addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		return false;
+	}
+	madvise(addr, info.st_size, MADV_SEQUENTIAL);
+	myData = static_cast<const char *>(addr);
+	mySize = info.st_size;
+	myMapped = true;
+	return true;
+}
+
+void SourceFile::unmap(){
+	if (myMapped) {
+		munmap(const_cast<char *>(myData), mySize);
+	}
+	myData = nullptr;
+	mySize = 0;
+	myMapped = false;
+	myReleased = 0;
+}
+
+void SourceFile::release(size_t end){
+	static const size_t page = sysconf(_SC_PAGESIZE);
+	end = end < mySize ? end - end % page : mySize;
+	if (!myMapped || end <= myReleased) {
+		return;
+	}
+	madvise(const_cast<char *>(myData) + myReleased, end - myReleased, MADV_DONTNEED);
+	myReleased = end;
+}
+
+}
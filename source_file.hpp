@@ -0,0 +1,42 @@
+#ifndef LILC_SOURCE_FILE_HPP
+#define LILC_SOURCE_FILE_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace LILC{
+
+//A read-only, memory-mapped view of a whole input file. The scanner
+// reads straight out of the mapping and tokens point back into it, so
+// it has to outlive every token produced from it.
+class SourceFile{
+public:
+	SourceFile() = default;
+	~SourceFile();
+	SourceFile(const SourceFile&) = delete;
+	SourceFile& operator=(const SourceFile&) = delete;
+
+	// returns false if the file can't be mapped (it
+	// doesn't exist, or is stdin, a pipe, etc.)
+	bool map(const char * filename);
+	void unmap();
+	// Give back the memory of the mapped pages before offset end, which
+	// the caller is done reading. They stay mapped: a page read again is
+	// read back in from the file.
+	void release(size_t end);
+
+	const char * data() const { return myData; }
+	size_t size() const { return mySize; }
+	std::string_view text(size_t offset, size_t length) const {
+		return std::string_view(myData + offset, length);
+	}
+private:
+	const char * myData = nullptr;
+	size_t mySize = 0;
+	bool myMapped = false;
+	// the pages before this have been released
+	size_t myReleased = 0;
+};
+
+}
+#endif
@@ -1,104 +1,150 @@
+#include <cassert>
+
 #include "symbol_table.hpp"
 namespace LILC{
 
 SymbolTableEntry::SymbolTableEntry () {
-	this->id = "";
+	this->id = AtomTable::NoAtom;
 	this->kind = NotFound;
-	this->type = "";
+	this->type = TypeTable::global().none();
 	this->size = 0;
-	structScope = new SymbolTable();
-	structScope->addScope();
+	structScope = nullptr;
+	layout = nullptr;
 }
-SymbolTableEntry::SymbolTableEntry (std::string id, Kind kind, std::string type, int size) {
+SymbolTableEntry::SymbolTableEntry (Atom id, Kind kind, const Type * type, int size) {
 		this->id = id;
 		this->kind = kind;
 		this->type = type;
 		this->size = size;
-		structScope = new SymbolTable();
-		structScope->addScope();
+		structScope = nullptr;
+		layout = nullptr;
 }
 
-std::string SymbolTableEntry::getId() {
-	return id;
+SymbolTableEntry* SymbolTableEntry::notFound() {
+	static SymbolTableEntry entry;
+	return &entry;
+}
+
+SymbolTableEntry* SymbolTableEntry::findField(Atom id) {
+	if (layout != nullptr) {
+		const StructLayout::Field* field = layout->field(id);
+		return field != nullptr ? field->entry : notFound();
+	}
+	if (structScope == nullptr) {
+		return notFound();
+	}
+	return structScope->findEntry(id);
 }
 
-void SymbolTableEntry::setId(std::string id) {
-	this->id = id;
+Atom SymbolTableEntry::getId() {
+	return id;
 }
 
 Kind SymbolTableEntry::getKind() {
 	return kind;
 }
-void SymbolTableEntry::setKind(Kind kind) {
-	this->kind = kind;
-}
-std::string SymbolTableEntry::getType() {
+const Type * SymbolTableEntry::getType() {
 	return type;
 }
-void SymbolTableEntry::setType(std::string type) {
-	this->type = type;
-}
 int SymbolTableEntry::getSize() {
 	return size;
 }
-void SymbolTableEntry::setSize(int size) {
-	this->size = size;
+
+StructLayout::StructLayout(SymbolTableEntry* decl, const std::vector<SymbolTableEntry *>& fields)
+: decl(decl) {
+	//reserved, so the Fields byName points to never move
+	this->fields.reserve(fields.size());
+	for (SymbolTableEntry* entry : fields) {
+		this->fields.push_back(Field{entry, size});
+		byName.insert(entry->getId(), &this->fields.back());
+		size += entry->getSize();
+	}
+}
+
+int StructLayout::sizeOf(const Type * type) {
+	switch (type->kind()) {
+	case Type::Kind::Int:
+	case Type::Kind::Bool:
+		return WORD;
+	default:
+		return 0;
+	}
+}
+
+int StructLayout::sizeOf(SymbolTableEntry* structDecl) {
+	//a struct with a field of its own type has no layout yet
+	const StructLayout* layout = structDecl->getLayout();
+	return layout != nullptr ? layout->getSize() : 0;
 }
 
 ScopeTable::ScopeTable(){
-	map = new std::unordered_map<std::string, SymbolTableEntry *>();
 }
 
-bool ScopeTable::addEntry(std::string id, SymbolTableEntry* entry) {
-	return map->insert({id, entry}).second;
+bool ScopeTable::addEntry(Atom id, SymbolTableEntry* entry) {
+	return map.insert(id, entry);
 }
 
-SymbolTableEntry* ScopeTable::getEntry(std::string id) {
-	auto entry = map->find(id);
-	if (entry != map->end()) {
-		return entry->second;
+SymbolTableEntry* ScopeTable::getEntry(Atom id) {
+	SymbolTableEntry* entry = map.find(id);
+	if (entry != nullptr) {
+		return entry;
 	}
-	return new SymbolTableEntry();
+	return SymbolTableEntry::notFound();
+}
+
+bool ScopeTable::exists(Atom id) {
+	return map.find(id) != nullptr;
 }
 
-bool ScopeTable::exists(std::string id) {
-	auto entry = map->find(id);
-	return (entry != map->end());
+void ScopeTable::clear() {
+	map.clear();
 }
 
-SymbolTable::SymbolTable(){
-	//TODO: implement the list of hashtables
-	// approach to building a symbol table
-	scopeTables = new std::list<ScopeTable *>();
-	globalScope = nullptr;
-};
+void ScopeListTable::addScope() {
+	if (depth == scopeTables.size()) {
+		scopeTables.emplace_back(new ScopeTable());
+		hiding.push_back(0);
+	}
+	depth++;
+}
 
-void SymbolTable::addScope() {
-	ScopeTable* table = new ScopeTable();
-	scopeTables->push_back(table);
+void ScopeListTable::dropScope() {
+	if (depth > 0) {
+		scopeTables[--depth]->clear();
+		hidingStructs -= hiding[depth];
+		hiding[depth] = 0;
+	}
 }
 
-void SymbolTable::dropScope() {
-	if (!scopeTables->empty()) {
-		scopeTables->pop_back();
+bool ScopeListTable::addSymbol(Atom id, Kind kind, const Type * type, int size) {
+	ScopeTable * table = scopeTables[depth - 1].get();
+	if (table->exists(id)) {
+		return false;
 	}
+	//structs are only declared in the outermost scope
+	if (depth > 1 && isLaidOut(scopeTables[0]->getEntry(id))) {
+		hiding[depth - 1]++;
+		hidingStructs++;
+	}
+	return table->addEntry(id, newEntry(id, kind, type, size, depth > 1));
 }
 
-bool SymbolTable::addSymbol(std::string id, Kind kind, std::string type, int size) {
-	return scopeTables->back()->addEntry(id, new SymbolTableEntry(id, kind, type, size));;
+bool FieldTable::addSymbol(Atom id, Kind kind, const Type * type, int size) {
+	if (!ScopeListTable::addSymbol(id, kind, type, size)) {
+		return false;
+	}
+	fields.push_back(findEntry(id));
+	return true;
 }
 
-SymbolTableEntry* SymbolTable::findEntry(std::string id) {
-	for (std::list<ScopeTable *>::reverse_iterator
-		it=scopeTables->rbegin();
-		it != scopeTables->rend(); ++it){
-		ScopeTable * elt = *it;
-	  SymbolTableEntry* entry = elt->getEntry(id);
+SymbolTableEntry* ScopeListTable::findEntry(Atom id) {
+	for (size_t i = depth; i-- > 0; ) {
+	  SymbolTableEntry* entry = scopeTables[i]->getEntry(id);
 		if (entry->getKind() != NotFound) {
 			return entry;
 		}
 	}
-	return new SymbolTableEntry();
+	return SymbolTableEntry::notFound();
 }
 
 SymbolTable* SymbolTable::getGlobalScope() {
@@ -109,4 +155,82 @@ void SymbolTable::setGlobalScope(SymbolTable* table) {
 	globalScope = table;
 }
 
+SymbolTable* SymbolTable::getStructScope(SymbolTableEntry* entry) {
+	assert(entry != SymbolTableEntry::notFound());
+	if (entry->structScope == nullptr) {
+		structScopes.emplace_back(new FieldTable(entries));
+		entry->structScope = structScopes.back().get();
+		entry->structScope->addScope();
+	}
+	return entry->structScope;
+}
+
+const StructLayout* SymbolTable::setLayout(SymbolTableEntry* structDecl) {
+	assert(structDecl != SymbolTableEntry::notFound());
+	//getStructScope only makes FieldTables
+	FieldTable* fields = static_cast<FieldTable *>(getStructScope(structDecl));
+	layouts.emplace_back(new StructLayout(structDecl, fields->getFields()));
+	structDecl->layout = layouts.back().get();
+	structDecl->size = structDecl->layout->getSize();
+	layoutsByName.insert(structDecl->getId(), structDecl->layout);
+	return structDecl->layout;
+}
+
+SymbolTableEntry* SymbolTable::findStruct(const Type * type) {
+	if (type->kind() != Type::Kind::Struct) {
+		return SymbolTableEntry::notFound();
+	}
+	if (hidingStructs == 0) {
+		const StructLayout* layout = layoutsByName.find(type->structName());
+		if (layout != nullptr) {
+			return layout->getDecl();
+		}
+	}
+	return findEntry(type->structName());
+}
+
+void ScopeStackTable::addScope() {
+	scopeStarts.push_back(bindings.size());
+}
+
+void ScopeStackTable::dropScope() {
+	if (scopeStarts.empty()) {
+		return;
+	}
+	while (bindings.size() > scopeStarts.back()) {
+		const Binding& binding = bindings.back();
+		if (hides(binding.shadowed)) {
+			hidingStructs--;
+		}
+		innermost[binding.id] = binding.shadowed;
+		bindings.pop_back();
+	}
+	scopeStarts.pop_back();
+}
+
+bool ScopeStackTable::addSymbol(Atom id, Kind kind, const Type * type, int size) {
+	//only as large as the largest atom bound, not every atom interned
+	if (id >= innermost.size()) {
+		innermost.resize(id + 1, NoBinding);
+	}
+	uint32_t shadowed = innermost[id];
+	uint32_t scope = scopeStarts.size() - 1;
+	if (shadowed != NoBinding && bindings[shadowed].scope == scope) {
+		return false;
+	}
+	if (hides(shadowed)) {
+		hidingStructs++;
+	}
+	innermost[id] = bindings.size();
+	bindings.push_back(Binding{id, newEntry(id, kind, type, size, scope > 0), shadowed, scope});
+	return true;
+}
+
+SymbolTableEntry* ScopeStackTable::findEntry(Atom id) {
+	if (id >= innermost.size() || innermost[id] == NoBinding) {
+		return SymbolTableEntry::notFound();
+	}
+	return bindings[innermost[id]].entry;
+}
+
 }
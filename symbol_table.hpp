@@ -1,73 +1,250 @@
 #ifndef LILC_SYMBOL_TABLE_HPP
 #define LILC_SYMBOL_TABLE_HPP
-#include <unordered_map>
-#include <list>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <vector>
+
+#include "arena.hpp"
+#include "atom_map.hpp"
+#include "atom_table.hpp"
+#include "type_table.hpp"
 
 namespace LILC{
 class SymbolTable;
+class StructLayout;
 enum Kind {Var, Func, Struct, NotFound};
 //A single entry for one name in the symbol table
 class SymbolTableEntry{
 public:
-	SymbolTableEntry();
-	SymbolTableEntry (std::string id, Kind kind, std::string type, int size);
+	SymbolTableEntry (Atom id, Kind kind, const Type * type, int size);
+	// What lookups return for a name that isn't there: one shared
+	// entry of kind NotFound, so that a miss allocates nothing. It is
+	// shared by every table on every thread, so nothing may change
+	// it: entries have no setters, and the table's friend access
+	// refuses it.
+	static SymbolTableEntry* notFound();
 
-	std::string getId();
-	void setId(std::string id);
+	Atom getId();
 	Kind getKind();
-	void setKind(Kind kind);
-	std::string getType();
-	void setType(std::string type);
+	const Type * getType();
 	int getSize();
-	void setSize(int size);
+	// The table of a struct's fields, or null until a struct
+	// declaration has SymbolTable::getStructScope make it
 	SymbolTable* getStructScope() {
 		return structScope;
 	}
+	// The layout of a struct's fields, or null until its declaration
+	// has been analyzed
+	const StructLayout* getLayout() {
+		return layout;
+	}
+	// the field id of the struct, from its layout once there is one,
+	// without making the scope
+	SymbolTableEntry* findField(Atom id);
 private:
-	std::string id;
+	friend class SymbolTable;
+	SymbolTableEntry();
+	Atom id;
 	Kind kind;
-	std::string type;
+	const Type * type;
 	int size;
 	SymbolTable* structScope;
+	const StructLayout* layout;
+};
+
+//Where a struct's fields go in memory: each field in the order it was
+// declared, so a field's index is its place in that order, at an offset
+// that is the sum of the sizes before it. A declaration's layout is made
+// once, after its fields are analyzed, and kept by the SymbolTable
+// under the struct's name, so a dot-access goes from a variable's type
+// to the layout to the field, with a probe of the field's atom in the
+// layout's own map.
+class StructLayout{
+public:
+	// int and bool variables take a word each
+	static constexpr int WORD = 4;
+
+	struct Field{
+		SymbolTableEntry* entry;
+		int offset;
+	};
+
+	// fields in declaration order, each with its size already set
+	StructLayout(SymbolTableEntry* decl, const std::vector<SymbolTableEntry *>& fields);
+
+	// the entry of the struct's declaration
+	SymbolTableEntry* getDecl() const {
+		return decl;
+	}
+	// the field named id, or null if there is none
+	const Field* field(Atom id) const {
+		return byName.find(id);
+	}
+	size_t index(const Field* field) const {
+		return field - fields.data();
+	}
+	const std::vector<Field>& getFields() const {
+		return fields;
+	}
+	int getSize() const {
+		return size;
+	}
+
+	// the size of a variable of type, if it isn't a struct
+	static int sizeOf(const Type * type);
+	// the size of a variable of the struct structDecl declares
+	static int sizeOf(SymbolTableEntry* structDecl);
+
+private:
+	SymbolTableEntry* decl;
+	std::vector<Field> fields;
+	AtomMap<const Field *> byName;
+	int size = 0;
 };
 
 //A single
 class ScopeTable{
 	public:
 		ScopeTable();
-		//TODO: add functions for looking up symbols
-		// and/or returning information to indicate
-		// that the symbol does not exist within
-		// the current scope
-		SymbolTableEntry* getEntry(std::string id);
-		bool addEntry(std::string id, SymbolTableEntry* entry);
-		bool exists(std::string id);
+		// the entry bound to id in this scope, or
+		// SymbolTableEntry::notFound() if there is none
+		SymbolTableEntry* getEntry(Atom id);
+		bool addEntry(Atom id, SymbolTableEntry* entry);
+		bool exists(Atom id);
+		// empty, keeping the memory for the next scope
+		void clear();
 
 	private:
-		std::unordered_map<std::string, SymbolTableEntry *>* map;
+		AtomMap<SymbolTableEntry *> map;
 };
 
+//The scopes name analysis declares names in and looks them up in,
+// innermost last. Entries are made in the arena given, usually one for
+// the whole compilation, and live on after their scope is dropped, for
+// the IdNodes that point to them.
 class SymbolTable{
 	public:
-		SymbolTable();
-		//TODO: add functions to create a new scope
-		// table when a new scope is entered,
-		// drop a scope table when a scope is finished,
-		// etc.
-		void addScope();
-		void dropScope();
+		SymbolTable(Arena& entries) : entries(entries) { }
+		virtual ~SymbolTable() { }
+		// Make the entries of every scope but the outermost in locals
+		// instead, which the owner resets once nothing points to them:
+		// with the tree analyzed and unparsed a declaration at a time,
+		// after each top-level declaration.
+		void setLocalEntries(Arena* locals) { this->locals = locals; }
+		virtual void addScope() = 0;
+		virtual void dropScope() = 0;
 
 		// returns true if succesfully added
 		// false if already exists
-		bool addSymbol(std::string id, Kind kind, std::string type, int size);
-		SymbolTableEntry* findEntry(std::string id);
+		virtual bool addSymbol(Atom id, Kind kind, const Type * type, int size) = 0;
+		virtual SymbolTableEntry* findEntry(Atom id) = 0;
 		SymbolTable* getGlobalScope();
 		void setGlobalScope(SymbolTable* table);
+		// The table of entry's struct fields, made the first time it is
+		// asked for, with this table's arena; only struct declarations
+		// ask, so other entries never get one. This table owns it.
+		SymbolTable* getStructScope(SymbolTableEntry* entry);
+		// Lays out the fields declared in structDecl's struct scope, in
+		// the order they were declared, gives structDecl the layout and
+		// its size, and keeps it under the struct's name. This table
+		// owns it.
+		const StructLayout* setLayout(SymbolTableEntry* structDecl);
+		// What findEntry(type->structName()) returns: for a struct type,
+		// the entry its name is bound to in the current scope. While no
+		// local hides a struct's name that is the declaration of the
+		// layout kept under that name, and no scope is searched.
+		SymbolTableEntry* findStruct(const Type * type);
+
+	protected:
+		// an entry for the outermost scope, or (local) an inner one
+		SymbolTableEntry* newEntry(Atom id, Kind kind, const Type * type, int size,
+		  bool local) {
+			Arena& arena = local && locals != nullptr ? *locals : entries;
+			return arena.make<SymbolTableEntry>(id, kind, type, size);
+		}
+		// whether entry declares a struct that has been laid out
+		static bool isLaidOut(SymbolTableEntry* entry) {
+			return entry->getLayout() != nullptr;
+		}
+		// the bindings in open scopes that hide a laid-out struct's
+		// name; kept by the implementations as they add and drop them
+		size_t hidingStructs = 0;
+
+	private:
+		Arena& entries;
+		Arena* locals = nullptr;
+		SymbolTable* globalScope = nullptr;
+		std::vector<std::unique_ptr<SymbolTable>> structScopes;
+		std::vector<std::unique_ptr<StructLayout>> layouts;
+		AtomMap<const StructLayout *> layoutsByName;
+};
+
+//A list of ScopeTables, searched from the innermost out, so a lookup
+// costs a probe per scope. Struct field scopes, which have only the
+// one scope, are these. A dropped scope's table is cleared and kept for
+// the next scope opened at that depth, so once the deepest nesting has
+// been seen, opening and closing scopes allocates nothing.
+class ScopeListTable : public SymbolTable{
+	public:
+		ScopeListTable(Arena& entries) : SymbolTable(entries) { }
+		void addScope();
+		void dropScope();
+		bool addSymbol(Atom id, Kind kind, const Type * type, int size);
+		SymbolTableEntry* findEntry(Atom id);
+
+	private:
+		// the open scopes are the first depth, innermost last
+		std::vector<std::unique_ptr<ScopeTable>> scopeTables;
+		size_t depth = 0;
+		// by depth, how many of hidingStructs are in that scope
+		std::vector<size_t> hiding;
+};
+
+//The one scope of a struct's fields, which also keeps the fields in the
+// order they were declared, for the struct's layout
+class FieldTable : public ScopeListTable{
+	public:
+		FieldTable(Arena& entries) : ScopeListTable(entries) { }
+		bool addSymbol(Atom id, Kind kind, const Type * type, int size);
+		const std::vector<SymbolTableEntry *>& getFields() {
+			return fields;
+		}
+
+	private:
+		std::vector<SymbolTableEntry *> fields;
+};
+
+//One table for every scope, indexed by atom: each name's innermost
+// binding is one lookup away, and shadows the binding before it, of
+// the same name in an outer scope. The bindings are kept in the order
+// they were made, so dropping a scope undoes just the ones it made.
+class ScopeStackTable : public SymbolTable{
+	public:
+		ScopeStackTable(Arena& entries) : SymbolTable(entries) { }
+		void addScope();
+		void dropScope();
+		bool addSymbol(Atom id, Kind kind, const Type * type, int size);
+		SymbolTableEntry* findEntry(Atom id);
 
 	private:
-		std::list<ScopeTable *> * scopeTables;
-		SymbolTable* globalScope;
+		static constexpr uint32_t NoBinding = UINT32_MAX;
+		struct Binding{
+			Atom id;
+			SymbolTableEntry* entry;
+			uint32_t shadowed; //the binding of id this one hides
+			uint32_t scope;
+		};
+		// whether a binding that hides shadowed hides a struct
+		bool hides(uint32_t shadowed) {
+			return shadowed != NoBinding && isLaidOut(bindings[shadowed].entry);
+		}
+		// by atom, the innermost binding, or NoBinding; grown to the
+		// largest atom this table binds
+		std::vector<uint32_t> innermost;
+		std::vector<Binding> bindings;
+		// where each open scope's bindings start
+		std::vector<uint32_t> scopeStarts;
 };
 
 }
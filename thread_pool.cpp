@@ -0,0 +1,62 @@
+#include "thread_pool.hpp"
+
+namespace LILC{
+
+ThreadPool::ThreadPool(unsigned threads){
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+	for (unsigned i = 0; i < threads; i++) {
+		myWorkers.emplace_back([this]{ work(); });
+	}
+}
+
+ThreadPool::~ThreadPool(){
+	{
+		std::lock_guard<std::mutex> guard(myLock);
+		myStopping = true;
+	}
+	myWake.notify_all();
+	for (std::thread& worker : myWorkers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task){
+	{
+		std::lock_guard<std::mutex> guard(myLock);
+		myTasks.push_back(std::move(task));
+		myPending++;
+	}
+	myWake.notify_one();
+}
+
+void ThreadPool::wait(){
+	std::unique_lock<std::mutex> guard(myLock);
+	myIdle.wait(guard, [this]{ return myPending == 0; });
+}
+
+void ThreadPool::work(){
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> guard(myLock);
+			myWake.wait(guard, [this]{ return myStopping || !myTasks.empty(); });
+			if (myTasks.empty()) {
+				return;
+			}
+			task = std::move(myTasks.front());
+			myTasks.pop_front();
+		}
+		task();
+		std::lock_guard<std::mutex> guard(myLock);
+		if (--myPending == 0) {
+			myIdle.notify_all();
+		}
+	}
+}
+
+}
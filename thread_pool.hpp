@@ -0,0 +1,40 @@
+#ifndef LILC_THREAD_POOL_HPP
+#define LILC_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LILC{
+
+//A fixed set of worker threads pulling tasks off one queue.
+class ThreadPool{
+public:
+	// threads == 0 means one per hardware thread
+	ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void submit(std::function<void()> task);
+	// blocks until every submitted task has finished
+	void wait();
+	unsigned size() const { return myWorkers.size(); }
+
+private:
+	void work();
+
+	std::vector<std::thread> myWorkers;
+	std::deque<std::function<void()>> myTasks;
+	std::mutex myLock;
+	std::condition_variable myWake;
+	std::condition_variable myIdle;
+	size_t myPending = 0;
+	bool myStopping = false;
+};
+
+}
+#endif
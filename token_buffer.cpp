@@ -0,0 +1,57 @@
+#include "token_buffer.hpp"
+
+namespace LILC{
+
+void TokenBuffer::reserve(size_t capacity){
+	if (capacity <= myCapacity) {
+		return;
+	}
+	//The old array is left in the arena; it goes away with the rest
+	// of it in clear()
+	TokenRec * grown = myArena.makeArray<TokenRec>(capacity);
+	if (mySize > 0) {
+		memcpy(grown, myTokens, mySize * sizeof(TokenRec));
+	}
+	myTokens = grown;
+	myCapacity = capacity;
+}
+
+void TokenBuffer::splice(size_t first, size_t last, const TokenRec * recs,
+  size_t count, int64_t shift){
+	size_t tail = mySize - last;
+	size_t size = first + count + tail;
+	if (size > myCapacity) {
+		size_t capacity = myCapacity * 2;
+		reserve(capacity < size ? size : capacity);
+	}
+	TokenRec * after = myTokens + first + count;
+	if (tail > 0 && first + count != last) {
+		memmove(after, myTokens + last, tail * sizeof(TokenRec));
+	}
+	if (count > 0) {
+		memcpy(myTokens + first, recs, count * sizeof(TokenRec));
+	}
+	if (shift != 0) {
+		for (size_t i = 0; i < tail; i++) {
+			after[i].offset += shift;
+		}
+	}
+	mySize = size;
+}
+
+void TokenBuffer::clear(){
+	myArena.release();
+	myText.release();
+	myTokens = nullptr;
+	mySize = 0;
+	myCapacity = 0;
+	myStrings.clear();
+}
+
+void TokenBuffer::drop(){
+	myText.reset();
+	mySize = 0;
+	myStrings.clear();
+}
+
+}
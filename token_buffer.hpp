@@ -0,0 +1,100 @@
+#ifndef LILC_TOKEN_BUFFER_HPP
+#define LILC_TOKEN_BUFFER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "arena.hpp"
+
+namespace LILC{
+
+//One scanned token. What payload means depends on tag:
+// ID             the identifier's Atom
+// INTLITERAL     the (already clamped) value
+// STRINGLITERAL  an index into TokenBuffer::stringAt
+// anything else  unused
+struct TokenRec{
+	uint32_t tag;
+	uint32_t offset; //byte offset of the token in the input
+	uint32_t payload;
+};
+
+//A whole input's worth of tokens (or a window of it, see TokenSource),
+// stored as one contiguous TokenRec array in an arena. Nothing in here
+// is freed individually; clear() drops it all at once.
+class TokenBuffer{
+public:
+	TokenBuffer() = default;
+	TokenBuffer(const TokenBuffer&) = delete;
+	TokenBuffer& operator=(const TokenBuffer&) = delete;
+
+	void push(uint32_t tag, uint32_t offset, uint32_t payload = 0){
+		if (mySize == myCapacity) {
+			reserve(myCapacity == 0 ? 1024 : myCapacity * 2);
+		}
+		myTokens[mySize++] = TokenRec{tag, offset, payload};
+	}
+	void reserve(size_t capacity);
+
+	// Record a string literal's text and return its payload index.
+	// The text must outlive the buffer (see copyText) unless
+	// copyStrings is set.
+	uint32_t addString(std::string_view text){
+		if (myCopyStrings) {
+			text = copyText(text.data(), text.size());
+		}
+		myStrings.push_back(text);
+		return myStrings.size() - 1;
+	}
+	// Keep a private copy of every string literal, for input that
+	// will change under the buffer (see relex)
+	void setCopyStrings(bool copy) { myCopyStrings = copy; }
+	// Copy text into the buffer's own storage, for input that
+	// doesn't stay around (i.e. the stream path)
+	std::string_view copyText(const char * text, size_t length){
+		return myText.copy(std::string_view(text, length));
+	}
+	std::string_view stringAt(uint32_t index) const { return myStrings[index]; }
+
+	size_t size() const { return mySize; }
+	const TokenRec& operator[](size_t i) const { return myTokens[i]; }
+	const TokenRec * begin() const { return myTokens; }
+	const TokenRec * end() const { return myTokens + mySize; }
+
+	// Replace tokens [first, last) with count records from recs and
+	// move every token after them by shift bytes
+	void splice(size_t first, size_t last, const TokenRec * recs,
+	  size_t count, int64_t shift);
+
+	void clear();
+	// Like clear(), but keeps the token array for the tokens that come
+	// next, when the buffer holds an input a window at a time
+	void drop();
+
+private:
+	Arena myArena;
+	// copies of string literals (see copyText)
+	Arena myText;
+	TokenRec * myTokens = nullptr;
+	size_t mySize = 0;
+	size_t myCapacity = 0;
+	std::vector<std::string_view> myStrings;
+	bool myCopyStrings = false;
+};
+
+//Where a parser gets more of its input, when its buffer only holds a
+// window of it (see LilC_Compiler::setStreaming)
+class TokenSource{
+public:
+	virtual ~TokenSource() { }
+	// Called once the parser has read past the last token in tokens,
+	// when it is done with every one of them: replaces them with the
+	// next window's and returns true, or returns false at the end of
+	// the input.
+	virtual bool refill() = 0;
+};
+
+}
+#endif
@@ -0,0 +1,53 @@
+#ifndef LILC_TOKEN_CURSOR_HPP
+#define LILC_TOKEN_CURSOR_HPP
+
+#include "grammar.hh"
+#include "token_buffer.hpp"
+
+namespace LILC{
+
+//Hands a scanned TokenBuffer to the parser one token at a time, in
+// place of a scanner. The semantic value of an identifier or literal is
+// a pointer to its record in the buffer (the other tokens have none),
+// and the location of any token is its offset.
+//
+// With a source, the buffer holds a window of the input, and the cursor
+// refills it once the parser asks for the token after its last. That
+// leaves the values of the tokens before pointing at the new window's
+// records, which is safe because the rules that take an identifier or
+// literal are reduced as soon as it is shifted, without a lookahead.
+class TokenCursor{
+public:
+	TokenCursor(const TokenBuffer& tokens, TokenSource * source = nullptr)
+	: myTokens(tokens), mySource(source) { }
+
+	int yylex(LILC::LilC_Parser::semantic_type * const lval,
+	  LILC::LilC_Parser::location_type * const loc){
+		if (myPos == myTokens.size()) {
+			if (mySource == nullptr || !mySource->refill()) {
+				return LILC::LilC_Parser::token::END;
+			}
+			myPos = 0;
+		}
+		const TokenRec& tok = myTokens[myPos++];
+		switch (tok.tag) {
+		case LILC::LilC_Parser::token::ID:
+		case LILC::LilC_Parser::token::INTLITERAL:
+		case LILC::LilC_Parser::token::STRINGLITERAL:
+			lval->tokenRec = &tok;
+			break;
+		}
+		*loc = tok.offset;
+		return tok.tag;
+	}
+	void rewind() { myPos = 0; }
+	const TokenBuffer& tokens() const { return myTokens; }
+
+private:
+	const TokenBuffer& myTokens;
+	TokenSource * mySource;
+	size_t myPos = 0;
+};
+
+}
+#endif
@@ -0,0 +1,160 @@
+#include <cstring>
+#include <vector>
+
+#include "token_file.hpp"
+#include "grammar.hh"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+static const char MAGIC[8] = { 'L', 'I', 'L', 'C', 'T', 'O', 'K', '1' };
+
+bool writeTokenFile(const TokenBuffer& tokens, BufferedWriter& out){
+	//Renumber atoms densely, in first-use order
+	std::vector<uint32_t> fileAtom(AtomTable::global().size(), UINT32_MAX);
+	std::vector<Atom> atoms;
+	uint32_t strings = 0;
+	for (const TokenRec& tok : tokens) {
+		if (tok.tag == TokenTag::ID && fileAtom[tok.payload] == UINT32_MAX) {
+			fileAtom[tok.payload] = atoms.size();
+			atoms.push_back(tok.payload);
+		} else if (tok.tag == TokenTag::STRINGLITERAL) {
+			strings++;
+		}
+	}
+
+	out.write(MAGIC, sizeof(MAGIC));
+	out.writeU32(atoms.size());
+	out.writeU32(strings);
+	out.writeU32(tokens.size());
+	for (Atom atom : atoms) {
+		std::string_view text = atomText(atom);
+		out.writeU32(text.size());
+		out << text;
+	}
+	for (const TokenRec& tok : tokens) {
+		if (tok.tag == TokenTag::STRINGLITERAL) {
+			std::string_view text = tokens.stringAt(tok.payload);
+			out.writeU32(text.size());
+			out << text;
+		}
+	}
+	strings = 0;
+	for (const TokenRec& tok : tokens) {
+		uint32_t payload = tok.payload;
+		if (tok.tag == TokenTag::ID) {
+			payload = fileAtom[payload];
+		} else if (tok.tag == TokenTag::STRINGLITERAL) {
+			payload = strings++;
+		}
+		out.writeU32(tok.tag);
+		out.writeU32(tok.offset);
+		out.writeU32(payload);
+	}
+	return !out.failed();
+}
+
+bool isTokenFile(const SourceFile& file){
+	return file.size() >= sizeof(MAGIC)
+	  && memcmp(file.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+//Reads from a mapped token file, watching for the end of it
+class TokenFileReader{
+public:
+	TokenFileReader(const SourceFile& file)
+	  : myPos(file.data()), myEnd(file.data() + file.size()) { }
+	bool u32(uint32_t * value){
+		if (myEnd - myPos < 4) {
+			return false;
+		}
+		memcpy(value, myPos, 4);
+		myPos += 4;
+		return true;
+	}
+	bool text(std::string_view * value){
+		uint32_t length;
+		if (!u32(&length) || (size_t)(myEnd - myPos) < length) {
+			return false;
+		}
+		*value = std::string_view(myPos, length);
+		myPos += length;
+		return true;
+	}
+	void skip(size_t count){ myPos += count; }
+	size_t remaining() const { return myEnd - myPos; }
+private:
+	const char * myPos;
+	const char * myEnd;
+};
+
+//Whether tag is one the scanners make, END aside
+static bool isTokenTag(uint32_t tag){
+	return tag >= TokenTag::BOOL && tag <= TokenTag::ASSIGN;
+}
+
+bool readTokenFile(const SourceFile& file, TokenBuffer * out){
+	if (!isTokenFile(file)) {
+		return false;
+	}
+	TokenFileReader in(file);
+	in.skip(sizeof(MAGIC));
+	uint32_t atomCount, stringCount, tokenCount;
+	if (!in.u32(&atomCount) || !in.u32(&stringCount) || !in.u32(&tokenCount)) {
+		return false;
+	}
+	//each atom and string takes at least its length word
+	if (in.remaining() / 4 < (uint64_t)atomCount + stringCount) {
+		return false;
+	}
+	std::vector<Atom> atoms(atomCount);
+	for (uint32_t i = 0; i < atomCount; i++) {
+		std::string_view text;
+		if (!in.text(&text)) {
+			return false;
+		}
+		atoms[i] = AtomTable::global().intern(text);
+	}
+	//The file mapping doesn't outlive the buffer, so strings are copied
+	std::vector<uint32_t> strings(stringCount);
+	for (uint32_t i = 0; i < stringCount; i++) {
+		std::string_view text;
+		if (!in.text(&text)) {
+			return false;
+		}
+		strings[i] = out->addString(out->copyText(text.data(), text.size()));
+	}
+	//Each token is three words; a count the file can't hold is not
+	//worth allocating for
+	if (tokenCount == 0 || in.remaining() / 12 < tokenCount) {
+		return false;
+	}
+	out->reserve(tokenCount);
+	for (uint32_t i = 0; i < tokenCount; i++) {
+		uint32_t tag, offset, payload;
+		if (!in.u32(&tag) || !in.u32(&offset) || !in.u32(&payload)) {
+			return false;
+		}
+		//The parser runs up to the END at the end, and only that one,
+		//without checking the bounds
+		if (i + 1 == tokenCount ? tag != TokenTag::END : !isTokenTag(tag)) {
+			return false;
+		}
+		if (tag == TokenTag::ID) {
+			if (payload >= atomCount) {
+				return false;
+			}
+			payload = atoms[payload];
+		} else if (tag == TokenTag::STRINGLITERAL) {
+			if (payload >= stringCount) {
+				return false;
+			}
+			payload = strings[payload];
+		}
+		out->push(tag, offset, payload);
+	}
+	return true;
+}
+
+}
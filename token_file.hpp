@@ -0,0 +1,31 @@
+#ifndef LILC_TOKEN_FILE_HPP
+#define LILC_TOKEN_FILE_HPP
+
+#include "buffered_writer.hpp"
+#include "source_file.hpp"
+#include "token_buffer.hpp"
+
+namespace LILC{
+
+//The binary token stream written by P4 --tokens --binary. It holds all
+// the parser needs, so a saved stream can be parsed again without
+// scanning. Integers are 32-bit in host byte order.
+//
+//   "LILCTOK1"
+//   atom count, string count, token count
+//   each atom:    length, bytes
+//   each string:  length, bytes
+//   each token:   tag, offset, payload
+//
+// ID payloads index the file's own atom list (it is interned again on
+// load), STRINGLITERAL payloads the string list. The last token is END,
+// and no other is.
+// Returns false if a write to out has failed so far; close out to learn
+// about the rest
+bool writeTokenFile(const TokenBuffer& tokens, BufferedWriter& out);
+bool isTokenFile(const SourceFile& file);
+// Returns false (leaving out partly filled) if file is malformed
+bool readTokenFile(const SourceFile& file, TokenBuffer * out);
+
+}
+#endif
@@ -0,0 +1,23 @@
+#include "tokens.hpp"
+#include "grammar.hh"
+
+using TokenTag = LILC::LilC_Parser::token;
+
+namespace LILC{
+
+IDToken::IDToken(uint32_t offset, Atom value)
+: Token(offset,TokenTag::ID){
+	this->_value = value;
+}
+
+IntLitToken::IntLitToken(uint32_t offset, int value)
+: Token(offset,TokenTag::INTLITERAL){
+	this->_value = value;
+}
+
+StringLitToken::StringLitToken(uint32_t offset, std::string_view value)
+: Token(offset,TokenTag::STRINGLITERAL){
+	this->_value = value;
+}
+
+}
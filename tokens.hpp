@@ -1,32 +1,36 @@
 #ifndef LILC_SEMANTIC_SYMBOL_H
 #define LILC_SEMANTIC_SYMBOL_H
 
+#include <cstdint>
 #include <iostream>
+#include <string_view>
+
+#include "atom_table.hpp"
 
 namespace LILC{
 
 class Token {
 	public:
-		std::string name;
-		Token(size_t line, size_t column, int tag){ this->_tag = tag; }
+		Token(uint32_t offset, int tag){ this->_tag = tag; this->_offset = offset; }
 		int tag() { return _tag; }
-		size_t line;
-		size_t column;
+		//byte offset of the token in the source; see line_table.hpp
+		uint32_t offset() { return _offset; }
 
 	protected:
 		int _tag;
+		uint32_t _offset;
 };
 
 class NullaryToken : public Token {
 	public:
-		NullaryToken(size_t line, size_t col, int tag) : Token(line,col,tag) { };
+		NullaryToken(uint32_t offset, int tag) : Token(offset,tag) { };
 		int token() { return _tag; } 
 		
 };
 
 class IntLitToken : public Token {
 	public:
-		IntLitToken(size_t line, size_t col, int value); //Defined in lilc_lexer.l
+		IntLitToken(uint32_t offset, int value); //Defined in tokens.cpp
 		int value() { return _value; }
 	private:
 		int _value;
@@ -34,18 +38,19 @@ class IntLitToken : public Token {
 
 class IDToken : public Token {
 	public:
-		IDToken(size_t line, size_t col, std::string id); //Defined in lilc_lexer.l
-		std::string value() { return _value; }
+		IDToken(uint32_t offset, Atom id); //Defined in tokens.cpp
+		Atom atom() { return _value; }
+		std::string_view value() { return atomText(_value); }
 	private:
-		std::string _value;
+		Atom _value;
 };
 
 class StringLitToken : public Token {
 	public:
-		StringLitToken(size_t line, size_t col, std::string value); //Defined in lilc_lexer.l
-		std::string value() { return _value; }
+		StringLitToken(uint32_t offset, std::string_view value); //Defined in tokens.cpp
+		std::string_view value() { return _value; }
 	private:
-		std::string _value;
+		std::string_view _value;
 };
 
 } //End namespace
@@ -0,0 +1,46 @@
+#include "type_table.hpp"
+
+namespace LILC{
+
+TypeTable& TypeTable::global(){
+	static TypeTable table;
+	return table;
+}
+
+TypeTable::TypeTable()
+: myNone(Type::Kind::None, AtomTable::NoAtom, ""),
+  myInt(Type::Kind::Int, AtomTable::NoAtom, "int"),
+  myBool(Type::Kind::Bool, AtomTable::NoAtom, "bool"),
+  myVoid(Type::Kind::Void, AtomTable::NoAtom, "void"),
+  myStructName(Type::Kind::StructName, AtomTable::NoAtom, "struct") { }
+
+const Type * TypeTable::structType(Atom name){
+	std::lock_guard<std::mutex> lock(myLock);
+	std::unique_ptr<Type>& type = myStructs[name];
+	if (type == nullptr) {
+		type.reset(new Type(Type::Kind::Struct, name, std::string(atomText(name))));
+	}
+	return type.get();
+}
+
+const Type * TypeTable::function(const std::vector<const Type *>& params, const Type * result){
+	std::vector<const Type *> key(params);
+	key.push_back(result);
+	std::lock_guard<std::mutex> lock(myLock);
+	std::unique_ptr<Type>& type = myFunctions[key];
+	if (type == nullptr) {
+		std::string spelling;
+		for (size_t i = 0; i < params.size(); i++) {
+			if (i > 0) {
+				spelling += ",";
+			}
+			spelling += params[i]->spelling();
+		}
+		spelling += "->";
+		spelling += result->spelling();
+		type.reset(new Type(Type::Kind::Function, AtomTable::NoAtom, spelling));
+	}
+	return type.get();
+}
+
+}
@@ -0,0 +1,78 @@
+#ifndef LILC_TYPE_TABLE_HPP
+#define LILC_TYPE_TABLE_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "atom_table.hpp"
+
+namespace LILC{
+
+//A type, made once per distinct type by TypeTable: two types are the
+// same exactly when they are the same pointer.
+class Type{
+public:
+	enum class Kind : uint8_t {
+		None,       //of an entry that wasn't found
+		Int, Bool, Void,
+		Struct,     //of a variable of struct type
+		StructName, //of the name a struct declaration declares
+		Function
+	};
+
+	Kind kind() const { return myKind; }
+	// the struct's name for a Struct, NoAtom for anything else
+	Atom structName() const { return myName; }
+	// as unparse prints it: "int", the struct's name, "struct",
+	// "int,bool->void"
+	std::string_view spelling() const { return mySpelling; }
+
+private:
+	friend class TypeTable;
+	Type(Kind kind, Atom name, std::string spelling)
+	: myKind(kind), myName(name), mySpelling(std::move(spelling)) { }
+
+	Kind myKind;
+	Atom myName;
+	std::string mySpelling;
+};
+
+//Every type made so far. Like AtomTable, there is one for the whole
+// program; struct types may be asked for while bodies are parsed on
+// other threads, so making a new type takes a lock.
+class TypeTable{
+public:
+	static TypeTable& global();
+
+	const Type * none() const { return &myNone; }
+	const Type * intType() const { return &myInt; }
+	const Type * boolType() const { return &myBool; }
+	const Type * voidType() const { return &myVoid; }
+	const Type * structName() const { return &myStructName; }
+	// the type of variables declared "struct name"
+	const Type * structType(Atom name);
+	// the type of a function taking params and returning result
+	const Type * function(const std::vector<const Type *>& params, const Type * result);
+
+private:
+	TypeTable();
+
+	Type myNone;
+	Type myInt;
+	Type myBool;
+	Type myVoid;
+	Type myStructName;
+	std::unordered_map<Atom, std::unique_ptr<Type>> myStructs;
+	// keyed by the parameter types, then the result
+	std::map<std::vector<const Type *>, std::unique_ptr<Type>> myFunctions;
+	std::mutex myLock;
+};
+
+}
+#endif
@@ -7,21 +7,21 @@ void ProgramNode::unparse(std::ostream& out, int indent){
 }
 
 void DeclListNode::unparse(std::ostream& out, int indent){
-	for (std::list<DeclNode *>::iterator
-		it=myDecls->begin();
-		it != myDecls->end(); ++it){
+	for (DeclSpan::iterator
+		it=myDecls.begin();
+		it != myDecls.end(); ++it){
 	    DeclNode * elt = *it;
 	    elt->unparse(out, indent);
 	}
 }
 
 void FormalsListNode::unparse(std::ostream& out, int indent){
-	for (std::list<FormalDeclNode *>::iterator
-		it=myFormals->begin();
-		it != myFormals->end(); ++it){
+	for (FormalsSpan::iterator
+		it=myFormals.begin();
+		it != myFormals.end(); ++it){
 	    FormalDeclNode * elt = *it;
 	    elt->unparse(out, indent);
-		if(next(it) != myFormals->end())
+		if(it + 1 != myFormals.end())
 		{
 			out << ", ";
 		}
@@ -37,11 +37,11 @@ void FnBodyNode::unparse(std::ostream& out, int indent){
 }
 
 void ExpListNode::unparse(std::ostream& out, int indent){
-	for (std::list<ExpNode *>::iterator it=myExps.begin();
+	for (ExpSpan::iterator it=myExps.begin();
 		it != myExps.end(); ++it){
 	    ExpNode * elt = *it;
 	    elt->unparse(out, indent);
-		if(next(it) != myExps.end())
+		if(it + 1 != myExps.end())
 		{
 			out << ", ";
 		}
@@ -49,8 +49,8 @@ void ExpListNode::unparse(std::ostream& out, int indent){
 }
 
 void StmtListNode::unparse(std::ostream& out, int indent){
-	for (std::list<StmtNode *>::iterator it=myStmts->begin();
-		it != myStmts->end(); ++it){
+	for (StmtSpan::iterator it=myStmts.begin();
+		it != myStmts.end(); ++it){
 	    StmtNode * elt = *it;
 	    elt->unparse(out, indent);
 	}
@@ -183,9 +183,9 @@ void ReturnStmtNode::unparse(std::ostream& out, int indent){
 }
 
 void IdNode::unparse(std::ostream& out, int indent){
-	out << myStrVal;
+	out << atomText(myAtom);
 	if (myEntry != nullptr) {
-		out << "(" << myEntry->getType() << ")";
+		out << "(" << myEntry->getType()->spelling() << ")";
 	}
 }
 
@@ -203,8 +203,7 @@ void VoidNode::unparse(std::ostream& out, int indent){
 
 void StructNode::unparse(std::ostream& out, int indent){
 	doIndent(out, indent);
-	out << "struct ";
-	myId->unparse(out, 0);
+	out << "struct " << atomText(myType->structName());
 }
 
 void IntLitNode::unparse(std::ostream& out, int indent){
@@ -265,110 +264,36 @@ void NotNode::unparse(std::ostream& out, int indent){
 	out << ")";
 }
 
-void PlusNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " + ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void MinusNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " - ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void TimesNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	myExp1->unparse(out, 0);
-	out << " * ";
-	myExp2->unparse(out, 0);
-}
-
-void DivideNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " / ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void AndNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " && ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void OrNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " || ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void EqualsNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " == ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void NotEqualsNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " != ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void LessNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " < ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void GreaterNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "(";
-	myExp1->unparse(out, 0);
-	out << " > ";
-	myExp2->unparse(out, 0);
-	out << ")";
-}
-
-void LessEqNode::unparse(std::ostream& out, int indent){
-	doIndent(out, indent);
-	out << "()";
-	myExp1->unparse(out, 0);
-	out << " <= ";
-	myExp2->unparse(out, 0);
-	out << ")";
+static const char * spelling(OpKind op){
+	switch (op){
+	case OpKind::Plus: return " + ";
+	case OpKind::Minus: return " - ";
+	case OpKind::Times: return " * ";
+	case OpKind::Divide: return " / ";
+	case OpKind::And: return " && ";
+	case OpKind::Or: return " || ";
+	case OpKind::Equals: return " == ";
+	case OpKind::NotEquals: return " != ";
+	case OpKind::Less: return " < ";
+	case OpKind::Greater: return " > ";
+	case OpKind::LessEq: return " <= ";
+	case OpKind::GreaterEq: return " >= ";
+	}
+	return "";
 }
 
-void GreaterEqNode::unparse(std::ostream& out, int indent){
+void BinaryExpNode::unparse(std::ostream& out, int indent){
 	doIndent(out, indent);
-	out << "(";
+	//TimesNode leaves out the parentheses, and LessEqNode opens them twice
+	if (myOp != OpKind::Times){
+		out << (myOp == OpKind::LessEq ? "()" : "(");
+	}
 	myExp1->unparse(out, 0);
-	out << " >= ";
+	out << spelling(myOp);
 	myExp2->unparse(out, 0);
-	out << ")";
+	if (myOp != OpKind::Times){
+		out << ")";
+	}
 }
 
 // void IntLitNode::unparse(std::ostream& out, int indent){